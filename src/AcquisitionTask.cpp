@@ -18,26 +18,43 @@
 
 #include "ProcessFrameTask.hpp"
 #include "StubFrameGrabber.hpp"
+#include "SyntheticFrameGrabber.hpp"
 
 namespace fort {
 namespace artemis {
 
-FrameGrabber::Ptr AcquisitionTask::LoadFrameGrabber(
-    const std::vector<std::string> &stubImagePaths, const CameraOptions &options
-) {
+FrameGrabber::Ptr AcquisitionTask::LoadFrameGrabber(const Options &options) {
+	const auto stubImagePaths = options.StubImagePaths();
+
+	// an unpaced stub delivers frames as fast as they are requested.
+	const double stubFPS = options.StubUnpaced ? 0.0 : options.Camera.FPS;
+
+	auto loadStub = [&]() -> FrameGrabber::Ptr {
+		if (options.Synthetic.Tags > 0) {
+			return std::make_shared<SyntheticFrameGrabber>(
+			    options.Synthetic,
+			    stubFPS
+			);
+		}
+		return std::make_shared<StubFrameGrabber>(
+		    stubImagePaths,
+		    stubFPS,
+		    options.StubPrefetch
+		);
+	};
 #ifdef ARTEMIS_STUB_FRAMEGRABBER_ONLY
-	return std::make_shared<StubFrameGrabber>(stubImagePaths, options.FPS);
+	return loadStub();
 #else
-	if (stubImagePaths.empty() == false) {
-		return std::make_shared<StubFrameGrabber>(stubImagePaths, options.FPS);
+	if (stubImagePaths.empty() == false || options.Synthetic.Tags > 0) {
+		return loadStub();
 	}
 #ifdef EURESYS_FRAMEGRABBER_SUPPORT
 	static Euresys::EGenTL egentl;
-	return std::make_shared<EuresysFrameGrabber>(egentl, options);
+	return std::make_shared<EuresysFrameGrabber>(egentl, options.Camera);
 #endif // EURESYS_FRAMEGRABBER_SUPPORT
 
 #ifdef HYPERION_FRAMEGRABBER_SUPPORT
-	return HyperionFrameGrabber::Create(0, options);
+	return HyperionFrameGrabber::Create(0, options.Camera);
 #endif
 
 #ifdef MULTICAM_FRAMEGRABBER_SUPPORT
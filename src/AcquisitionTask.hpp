@@ -17,10 +17,7 @@ typedef std::shared_ptr<ProcessFrameTask> ProcessFrameTaskPtr;
 
 class AcquisitionTask : public Task {
 public:
-	static FrameGrabber::Ptr LoadFrameGrabber(
-	    const std::vector<std::string> &stubImagePaths,
-	    const CameraOptions            &options
-	);
+	static FrameGrabber::Ptr LoadFrameGrabber(const Options &options);
 
 	AcquisitionTask(
 	    const FrameGrabber::Ptr &grabber, const ProcessFrameTaskPtr &process
@@ -27,10 +27,15 @@
 #include <unistd.h>
 
 #include "AcquisitionTask.hpp"
+#include "MetricsServer.hpp"
 #include "ProcessFrameTask.hpp"
 #include "UserInterfaceTask.hpp" // IWYU pragma: keep
 
+#include <fort/utils/Defer.hpp>
+
 #include "git.h"
+#include "utils/Metrics.hpp"
+#include "utils/SamplingProfiler.hpp"
 #include "utils/StringManipulation.hpp"
 
 namespace fort {
@@ -57,6 +62,17 @@ void Application::Execute(int argc, char **argv) {
 	    slog::String("SHA1", git_CommitSHA1())
 	);
 
+	if (options.Profile.File.empty() == false) {
+		SamplingProfiler::Start(
+		    options.Profile.File,
+		    options.Profile.Frequency,
+		    options.Profile.Samples
+		);
+	}
+	Defer {
+		SamplingProfiler::Stop();
+	};
+
 	Application application(options);
 	application.run();
 };
@@ -87,11 +103,8 @@ bool Application::interceptCommand(const Options &options) {
 	}
 
 	if (options.PrintResolution == true) {
-		auto resolution = AcquisitionTask::LoadFrameGrabber(
-		                      options.StubImagePaths(),
-		                      options.Camera
-		)
-		                      ->Resolution();
+		auto resolution =
+		    AcquisitionTask::LoadFrameGrabber(options)->Resolution();
 		std::cout << resolution.width() << " " << resolution.height()
 		          << std::endl;
 		return true;
@@ -236,10 +249,7 @@ Application::~Application() {
 Application::Application(const Options &options)
     : d_loop{g_main_loop_new(nullptr, FALSE)} {
 
-	d_grabber = AcquisitionTask::LoadFrameGrabber(
-	    options.StubImagePaths(),
-	    options.Camera
-	);
+	d_grabber = AcquisitionTask::LoadFrameGrabber(options);
 
 	d_process = std::make_shared<ProcessFrameTask>(
 	    options,
@@ -249,6 +259,17 @@ Application::Application(const Options &options)
 
 	d_acquisition = std::make_shared<AcquisitionTask>(d_grabber, d_process);
 
+	if (options.Metrics.Port != 0) {
+		d_metrics = std::make_shared<Metrics>();
+		d_process->RegisterMetrics(d_metrics);
+		d_metricsServer = std::make_unique<MetricsServer>(
+		    nullptr,
+		    d_metrics,
+		    options.Metrics.Address,
+		    options.Metrics.Port
+		);
+	}
+
 	g_unix_signal_add(SIGINT, Application::onSigint, this);
 }
 
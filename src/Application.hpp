@@ -14,6 +14,8 @@ class FrameGrabber;
 class AcquisitionTask;
 class ProcessFrameTask;
 class FullFrameExportTask;
+class Metrics;
+class MetricsServer;
 
 class Application {
 public:
@@ -48,6 +50,8 @@ private:
 	std::shared_ptr<ProcessFrameTask> d_process;
 	std::shared_ptr<AcquisitionTask>  d_acquisition;
 	std::atomic<int>                  d_workgroup = 0;
+	std::shared_ptr<Metrics>          d_metrics;
+	std::unique_ptr<MetricsServer>    d_metricsServer;
 
 	std::vector<std::thread> d_threads;
 	GMainLoop               *d_loop;
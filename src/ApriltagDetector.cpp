@@ -7,6 +7,9 @@
 #include "utils/Partitions.hpp"
 #include "utils/Slog.hpp"
 
+#include <apriltag/common/image_u8.h>
+#include <apriltag/common/matd.h>
+#include <apriltag/common/timeprofile.h>
 #include <apriltag/tag16h5.h>
 #include <apriltag/tag25h9.h>
 #include <apriltag/tag36h11.h>
@@ -21,37 +24,93 @@
 #include <fort/tags/fort-tags.hpp>
 #include <fort/tags/tag36ARTag.h>
 #include <fort/tags/tag36h10.h>
+#include <fort/time/Time.hpp>
 
 #include <Eigen/Core>
 #include <Eigen/StdVector>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <slog++/slog++.hpp>
 #include <stdexcept>
 
+extern "C" {
+// exported by apriltag, but not declared in its headers.
+zarray_t *apriltag_quad_thresh(apriltag_detector_t *td, image_u8_t *im);
+}
+
 namespace fort {
 namespace artemis {
 
 ApriltagDetector::ApriltagDetector(
     size_t maxParallel, const Size &size, const ApriltagOptions &options
 )
-    : d_family{createFamily(options.Family())}
+    : d_family{CreateFamily(options.Family())}
+    , d_decodeTable{loadDecodeTable(d_family.get(), options)}
+    , d_size{size}
+    , d_copyConfigured{NeedsPartitionCopy(options)}
+    , d_copyPartitions{d_copyConfigured}
+    , d_quadSigma{options.QuadSigma}
+    , d_blurKernel{
+          // apriltag blurs the decimated image otherwise.
+          d_copyPartitions ? GaussianKernel::ForQuadSigma(options.QuadSigma)
+                           : GaussianKernel{}
+      }
+    , d_tilesPerTask{std::max(options.TilesPerWorker, size_t(1))}
+    , d_stitchHalfWidth{options.StitchHalfWidth}
+    , d_pooledDecode{options.PooledDecode}
+    , d_motionThreshold{options.MotionThreshold}
+    , d_motionRefreshPeriod{options.MotionRefreshPeriod}
+    , d_merger{double(options.QuadMinClusterPixel)}
     , d_maximumConcurrency{uint32_t(maxParallel)} {
-	d_minimumDetectionDistanceSquared =
-	    options.QuadMinClusterPixel * options.QuadMinClusterPixel;
-
 	d_detectors.reserve(maxParallel);
 	d_detectors.reserve(maxParallel);
 
+	if (options.Mask.empty() == false) {
+		d_mask      = DetectionMask::Load(options.Mask, size);
+		d_maskCosts = std::make_unique<CostMap>(
+		    d_mask->ActiveAreaMap(COST_CELL_SIZE)
+		);
+		slog::Info(
+		    "masking detection",
+		    slog::String("task", "ApriltagDetection"),
+		    slog::Float(
+		        "activeRatio",
+		        d_mask->ActiveArea(Rect{{0, 0}, size}) /
+		            (double(size.width()) * double(size.height()))
+		    )
+		);
+	}
+
 	size_t bufferSize{0};
 
 	for (size_t i = 0; i < maxParallel; ++i) {
 
-		d_detectors.push_back(std::move(createDetector(options, d_family.get()))
-		);
+		d_detectors.push_back(createDetector(options, *d_decodeTable));
+		if (d_blurKernel.Empty() == false) {
+			// partitions are blurred while copied.
+			d_detectors.back()->quad_sigma = 0.0;
+		}
 
 		Partition partition;
-		PartitionRectangle(Rect{{0, 0}, size}, i + 1, partition);
-		AddMargin(size, 75, partition);
+		if (d_maskCosts != nullptr) {
+			// balances only the active area.
+			PartitionRectangle(
+			    Rect{{0, 0}, size},
+			    (i + 1) * d_tilesPerTask,
+			    *d_maskCosts,
+			    2 * PARTITION_MARGIN,
+			    partition
+			);
+		} else {
+			PartitionRectangle(
+			    Rect{{0, 0}, size},
+			    (i + 1) * d_tilesPerTask,
+			    partition
+			);
+		}
+		addOverlap(Rect{{0, 0}, size}, partition);
+		applyMask(partition);
 
 		// the first image is always the biggest one.
 		d_partitions.push_back(partition);
@@ -73,17 +132,103 @@ ApriltagDetector::ApriltagDetector(
 		    slog::Int("totalBytes", partitionSize)
 		);
 	}
-	d_buffer = Buffer{bufferSize};
-	slog::Info(
-	    "allocated buffer",
-	    slog::String("task", "ApriltagDetection"),
-	    slog::Float("size_MB", d_buffer.size / 1024.0f / 1024.0f),
-		slog::Int("size", d_buffer.size),
-		slog::Pointer("address",d_buffer.data)
-	);
+	if (options.VerifyTrackedTags && options.TrackingSweepPeriod > 1) {
+		if (QuadVerifier::Supports(d_family.get())) {
+			d_verifier = std::make_unique<QuadVerifier>(
+			    d_family.get(),
+			    DECODE_BITS_CORRECTED,
+			    options.QuadMinBWDiff,
+			    VERIFY_SEARCH_RADIUS
+			);
+			slog::Info(
+			    "verifying tracked tags",
+			    slog::String("task", "ApriltagDetection")
+			);
+		} else {
+			slog::Warn(
+			    "cannot verify tracked tags of this family",
+			    slog::String("family", d_family->name)
+			);
+		}
+	}
+
+	if (d_stitchHalfWidth > 0) {
+		slog::Info(
+		    "stitching partition borders",
+		    slog::String("task", "ApriltagDetection"),
+		    slog::Int("halfWidth", d_stitchHalfWidth)
+		);
+	}
+
+	if (d_motionThreshold > 0 && options.AdaptivePartitions) {
+		// tiles must keep the same position to compare them over frames.
+		slog::Warn("motion gating is disabled by adaptive partitions");
+		d_motionThreshold = 0;
+	} else if (d_motionThreshold > 0) {
+		slog::Info(
+		    "reusing detections of static tiles",
+		    slog::String("task", "ApriltagDetection"),
+		    slog::Int("threshold", d_motionThreshold),
+		    slog::Int("refreshPeriod", d_motionRefreshPeriod)
+		);
+	}
+
+	if (d_pooledDecode && d_motionThreshold > 0) {
+		// reused tiles keep their detections, not their quads.
+		slog::Warn("pooled decoding is disabled by motion gating");
+		d_pooledDecode = false;
+	} else if (d_pooledDecode && options.QuadSigma < 0.0f) {
+		slog::Warn("pooled decoding does not support sharpening");
+		d_pooledDecode = false;
+	} else if (d_pooledDecode) {
+		for (size_t i = 0; i < maxParallel; ++i) {
+			// crops are small, they are decoded at full resolution.
+			d_decoders.push_back(createDetector(options, *d_decodeTable));
+			d_decoders.back()->quad_decimate = 1.0f;
+		}
+		d_crops.resize(maxParallel);
+		slog::Info(
+		    "pooling quads of all partitions",
+		    slog::String("task", "ApriltagDetection")
+		);
+	}
 
-	d_images.resize(maxParallel);
-	d_detections.resize(maxParallel, nullptr);
+	if (options.AdaptivePartitions) {
+		d_costs =
+		    std::make_unique<CostMap>(size, COST_CELL_SIZE, COST_SMOOTHING);
+		if (d_maskCosts != nullptr) {
+			// partitions are shrunk to the active bounds, masked cells are
+			// never measured.
+			d_costs->MarkEmptyCells(*d_maskCosts);
+		}
+		bufferSize = size_t(bufferSize * ADAPTIVE_BUFFER_SLACK);
+		slog::Info(
+		    "adaptive partitions",
+		    slog::String("task", "ApriltagDetection"),
+		    slog::Int("cellSize", COST_CELL_SIZE)
+		);
+	}
+
+	if (d_copyPartitions) {
+		d_buffer = Buffer{bufferSize};
+		slog::Info(
+		    "allocated buffer",
+		    slog::String("task", "ApriltagDetection"),
+		    slog::Float("size_MB", d_buffer.size / 1024.0f / 1024.0f),
+		    slog::Int("size", d_buffer.size),
+		    slog::Pointer("address", d_buffer.data)
+		);
+	} else {
+		slog::Info(
+		    "detecting directly in frame buffer",
+		    slog::String("task", "ApriltagDetection")
+		);
+	}
+
+	d_images.reserve(maxParallel);
+	d_detections.reserve(maxParallel);
+	d_quads.resize(maxParallel, 0);
+	d_taskProfiles.resize(maxParallel);
 
 	setUpTaskflow();
 }
@@ -99,85 +244,640 @@ void ApriltagDetector::setUpTaskflow() {
 
 		        *const_cast<size_t *>(&d_task_size) =
 		            d_maximumConcurrency.load();
-		        *const_cast<Partition *>(&d_current_partition) =
-		            d_partitions[d_task_size - 1];
-
-		        size_t used = 0;
-		        for (size_t i = 0; i < d_task_size; ++i) {
-			        auto partition = d_current_partition[i];
-			        d_images[i]    = ImageU8{
-                        partition.width(),
-                        partition.height(),
-                        d_buffer.data + used
-                    };
-
-			        if ((used + d_images[i].NeededSize()) > d_buffer.size) {
-				        throw std::runtime_error(
-				            "not enough buffer size for partition:" +
-				            std::to_string(i) + " needed: " +
-				            std::to_string(d_images[i].NeededSize()) +
-				            " available: " + std::to_string(d_buffer.size) +
-				            " already used: " + std::to_string(used)
-				        );
-			        }
 
-			        used += d_images[i].NeededSize();
-			        slog::DTrace(
-			            "Partition allocated",
-			            slog::Int("i", i),
-			            slog::Pointer("pointer", d_images[i].buffer),
-			            slog::Int("size", d_images[i].NeededSize()),
-			            slog::Int("available", d_buffer.size - used)
+		        skipVerifiedTags();
+		        planPartitions();
+		        bool allocated = allocateImages();
+		        if (allocated == false && d_rois != nullptr) {
+			        slog::Warn(
+			            "tracked windows do not fit in buffer, processing "
+			            "full frame",
+			            slog::Int("windows", d_rois->size())
+			        );
+			        d_rois = nullptr;
+			        planPartitions();
+			        allocated = allocateImages();
+		        }
+		        if (allocated == false && d_costs != nullptr) {
+			        slog::Warn(
+			            "adaptive partitions do not fit in buffer, using equal "
+			            "partitions"
 			        );
+			        d_current_partition = d_partitions[d_task_size - 1];
+			        allocated           = allocateImages();
+		        }
+		        if (allocated == false) {
+			        throw std::runtime_error(
+			            "not enough buffer size for full frame partitions"
+			        );
+		        }
+
+		        // lists are never shrunk, to keep their capacity. The last one
+		        // holds the verified tags.
+		        if (d_detections.size() < d_current_partition.size() + 1) {
+			        d_detections.resize(d_current_partition.size() + 1);
+		        }
+		        for (auto &d : d_detections) {
+			        d.clear();
 		        }
+		        d_detections[d_current_partition.size()].swap(d_verified);
+		        if (d_partitionPools.size() < d_current_partition.size()) {
+			        d_partitionPools.resize(d_current_partition.size());
+		        }
+		        d_partitionTimes.assign(d_current_partition.size(), 0.0);
+		        d_partitionQuads.assign(d_current_partition.size(), 0);
+		        std::fill(d_quads.begin(), d_quads.end(), 0);
+		        if (d_profile != nullptr) {
+			        for (auto &p : d_taskProfiles) {
+				        p.Clear();
+			        }
+		        }
+		        resetTileHistory();
+		        d_nextPartition.store(0);
 	        })
 	        .name("allocatePartitionedROIs");
 
 	auto merge =
 	    d_taskflow
 	        .emplace([this]() {
-		        auto detections = std::vector<zarray_t *>{
-		            d_detections.begin(),
-		            d_detections.begin() + d_task_size
-		        };
-		        mergeDetection(detections, d_current_partition, *d_readout);
+		        const auto start = Time::Now();
+		        for (size_t k = 0; k < d_pool.size(); ++k) {
+			        auto &detections = d_detections[d_pool[k].Partition];
+			        detections.insert(
+			            detections.end(),
+			            d_pooledDetections[k].begin(),
+			            d_pooledDetections[k].end()
+			        );
+		        }
+		        const auto &merged = d_merger.Merge(d_detections);
+		        for (const auto &d : merged) {
+			        auto t = d_readout->add_tags();
+			        t->set_id(d.ID);
+			        t->set_x(d.X);
+			        t->set_y(d.Y);
+			        t->set_theta(d.Theta);
+		        }
+		        if (d_verifier != nullptr) {
+			        d_verifier->Update(
+			            d_readout->frameid(),
+			            merged,
+			            d_rois == nullptr
+			        );
+		        }
+
 		        size_t quads{0};
-		        for (size_t i = 0; i < d_task_size; ++i) {
-			        quads += d_detectors[i]->nquads;
+		        for (const auto &q : d_quads) {
+			        quads += q;
 		        }
 
 		        d_readout->set_quads(quads);
+		        recordCosts();
 
-		        for (auto &d : detections) {
-			        if (d != nullptr) {
-				        apriltag_detections_destroy(d);
+		        if (d_profile != nullptr) {
+			        d_profile->Clear();
+			        for (const auto &p : d_taskProfiles) {
+				        d_profile->Add(p);
 			        }
-			        d = nullptr;
+			        d_profile->Partitions = d_current_partition.size();
+			        d_profile->Quads      = quads;
+			        d_profile->Merge      = Time::Now().Sub(start).Seconds();
+		        }
+
+		        if (d_gating == false) {
+			        return;
+		        }
+		        // hermes::FrameReadout has no field for them, so frames with
+		        // reused tiles are logged, with one character per tile. On a
+		        // static arena that is every frame, hence the debug level.
+		        size_t reused = std::count(
+		            d_reusedTiles.begin(),
+		            d_reusedTiles.end(),
+		            uint8_t(1)
+		        );
+		        if (reused == 0) {
+			        return;
 		        }
+		        std::string tiles(d_reusedTiles.size(), '0');
+		        for (size_t j = 0; j < d_reusedTiles.size(); ++j) {
+			        if (d_reusedTiles[j] != 0) {
+				        tiles[j] = '1';
+			        }
+		        }
+		        slog::Debug(
+		            "reused static tiles",
+		            slog::String("task", "ApriltagDetection"),
+		            slog::Int("frameID", d_readout->frameid()),
+		            slog::Int("reused", reused),
+		            slog::String("tiles", tiles)
+		        );
 	        })
 	        .name("merge");
 
+	auto pool =
+	    d_taskflow
+	        .emplace([this]() {
+		        d_pool.clear();
+		        if (d_pooledDecode == false) {
+			        return;
+		        }
+		        for (size_t j = 0; j < d_current_partition.size(); ++j) {
+			        d_pool.insert(
+			            d_pool.end(),
+			            d_partitionPools[j].begin(),
+			            d_partitionPools[j].end()
+			        );
+		        }
+		        // lists are never shrunk, to keep their capacity.
+		        if (d_pooledDetections.size() < d_pool.size()) {
+			        d_pooledDetections.resize(d_pool.size());
+		        }
+		        for (auto &d : d_pooledDetections) {
+			        d.clear();
+		        }
+		        d_nextQuad.store(0);
+	        })
+	        .name("poolQuads");
+
 	for (size_t i = 0; i < d_maximumConcurrency; ++i) {
+		auto verify_i =
+		    d_taskflow
+		        .emplace([this, i]() {
+			        if (d_verifier == nullptr || d_rois == nullptr ||
+			            i >= d_verifyWorkers) {
+				        return;
+			        }
+			        d_verifier->Verify(
+			            d_input,
+			            d_readout->frameid(),
+			            i,
+			            d_verifyWorkers
+			        );
+		        })
+		        .name("verify[" + std::to_string(i) + "]");
+		verify_i.precede(allocatePartition);
+
 		auto detect_i =
 		    d_taskflow.emplace([this, i]() { cloneAndDetectPartition(i); }
 		    ).name("cloneAndDetect[" + std::to_string(i) + "]");
 		detect_i.succeed(allocatePartition);
-		detect_i.precede(merge);
+		detect_i.precede(pool);
+
+		auto decode_i =
+		    d_taskflow.emplace([this, i]() { decodePooledQuads(i); })
+		        .name("decodePooledQuads[" + std::to_string(i) + "]");
+		decode_i.succeed(pool);
+		decode_i.precede(merge);
+	}
+}
+
+void ApriltagDetector::planPartitions() {
+	const Rect frame{{0, 0}, d_size};
+
+	if (d_rois == nullptr && (d_costs == nullptr || d_costs->Empty())) {
+		d_current_partition = d_partitions[d_task_size - 1];
+		return;
+	}
+
+	d_current_partition.clear();
+	if (d_rois == nullptr) {
+		PartitionRectangle(
+		    frame,
+		    d_task_size * d_tilesPerTask,
+		    *d_costs,
+		    2 * PARTITION_MARGIN,
+		    d_current_partition
+		);
+		addOverlap(frame, d_current_partition);
+		applyMask(d_current_partition);
+		// costliest tiles first, so the cheapest fill up idle tasks at the end.
+		std::sort(
+		    d_current_partition.begin(),
+		    d_current_partition.end(),
+		    [this](const Rect &a, const Rect &b) {
+			    return d_costs->Cost(a) > d_costs->Cost(b);
+		    }
+		);
+		return;
+	}
+
+	// windows larger than a tile of the frame are split like the full frame,
+	// so a single task does not end up with most of the work.
+	const size_t tiles   = d_task_size * d_tilesPerTask;
+	const double maxArea = activeArea(frame) / double(tiles);
+	Partition    split;
+	for (auto roi : *d_rois) {
+		if (d_mask != nullptr) {
+			roi = d_mask->ActiveBounds(roi);
+			if (roi.width() <= 0 || roi.height() <= 0) {
+				continue;
+			}
+		}
+		const double area = activeArea(roi);
+		if (tiles == 1 || maxArea <= 0.0 || area <= maxArea) {
+			d_current_partition.push_back(roi);
+			continue;
+		}
+		const size_t pieces =
+		    std::min(tiles, size_t(std::ceil(area / maxArea)));
+		split.clear();
+		if (d_maskCosts != nullptr) {
+			PartitionRectangle(
+			    roi,
+			    pieces,
+			    *d_maskCosts,
+			    2 * PARTITION_MARGIN,
+			    split
+			);
+		} else {
+			PartitionRectangle(roi, pieces, split);
+		}
+		addOverlap(roi, split);
+		d_current_partition.insert(
+		    d_current_partition.end(),
+		    split.begin(),
+		    split.end()
+		);
+	}
+
+	// largest first, so the smallest windows fill up the idle tasks at the end.
+	std::sort(
+	    d_current_partition.begin(),
+	    d_current_partition.end(),
+	    [this](const Rect &a, const Rect &b) {
+		    return activeArea(a) > activeArea(b);
+	    }
+	);
+}
+
+double ApriltagDetector::activeArea(const Rect &rect) const {
+	if (d_mask != nullptr) {
+		return d_mask->ActiveArea(rect);
+	}
+	return double(rect.width()) * double(rect.height());
+}
+
+void ApriltagDetector::addOverlap(const Rect &bounds, Partition &tiles) const {
+	if (d_stitchHalfWidth <= 0) {
+		AddMargin(d_size, PARTITION_MARGIN, tiles);
+		return;
+	}
+	Partition strips;
+	BorderStrips(bounds, d_stitchHalfWidth, tiles, strips);
+	tiles.insert(tiles.end(), strips.begin(), strips.end());
+}
+
+void ApriltagDetector::applyMask(Partition &rects) const {
+	if (d_mask == nullptr) {
+		return;
+	}
+	for (auto &r : rects) {
+		r = d_mask->ActiveBounds(r);
+	}
+	rects.erase(
+	    std::remove_if(
+	        rects.begin(),
+	        rects.end(),
+	        [](const Rect &r) { return r.width() <= 0 || r.height() <= 0; }
+	    ),
+	    rects.end()
+	);
+}
+
+bool ApriltagDetector::allocateImages() {
+	d_images.resize(d_current_partition.size());
+	if (d_copyPartitions == false) {
+		for (size_t i = 0; i < d_current_partition.size(); ++i) {
+			d_images[i] = d_input.GetROI(d_current_partition[i]);
+		}
+		return true;
+	}
+
+	size_t used = 0;
+	for (size_t i = 0; i < d_current_partition.size(); ++i) {
+		const auto &partition = d_current_partition[i];
+		d_images[i]           = ImageU8{
+            partition.width(),
+            partition.height(),
+            d_buffer.data + used
+        };
+
+		if ((used + d_images[i].NeededSize()) > d_buffer.size) {
+			return false;
+		}
+
+		used += d_images[i].NeededSize();
+		slog::DTrace(
+		    "Partition allocated",
+		    slog::Int("i", i),
+		    slog::Pointer("pointer", d_images[i].buffer),
+		    slog::Int("size", d_images[i].NeededSize()),
+		    slog::Int("available", d_buffer.size - used)
+		);
+	}
+	return true;
+}
+
+void ApriltagDetector::resetTileHistory() {
+	// tracked windows move at every frame, only full frame tiles are gated.
+	d_gating = d_motionThreshold > 0 && d_rois == nullptr;
+	d_reusedTiles.assign(d_current_partition.size(), 0);
+	if (d_gating == false) {
+		return;
+	}
+	if (d_current_partition != d_gatedPartition) {
+		d_gatedPartition = d_current_partition;
+		d_tileHistory.clear();
+		d_tileHistory.resize(d_current_partition.size());
+		d_tileMeans.resize(d_current_partition.size());
+	}
+}
+
+void ApriltagDetector::poolQuads(size_t i, size_t j, image_u8_t *image) {
+	auto td = d_detectors[i].get();
+	timeprofile_clear(td->tp);
+	// same preprocessing than apriltag_detector_detect().
+	image_u8_t *quadImage = image;
+	if (td->quad_decimate > 1.0f) {
+		quadImage = image_u8_decimate(image, td->quad_decimate);
+	}
+	if (td->quad_sigma > 0.0f) {
+		int kernelSize = 4 * td->quad_sigma;
+		if ((kernelSize & 1) == 0) {
+			++kernelSize;
+		}
+		if (kernelSize > 1) {
+			image_u8_gaussian_blur(quadImage, td->quad_sigma, kernelSize);
+		}
+	}
+	zarray_t *quads = apriltag_quad_thresh(td, quadImage);
+	if (quadImage != image) {
+		image_u8_destroy(quadImage);
+	}
+	if (d_profile != nullptr) {
+		profileStages(i);
+	}
+
+	const auto &partition = d_current_partition[j];
+	const double scale    = std::max(td->quad_decimate, 1.0f);
+	auto        &pool     = d_partitionPools[j];
+	pool.clear();
+	for (int k = 0; k < zarray_size(quads); ++k) {
+		struct quad *q;
+		zarray_get_volatile(quads, k, &q);
+		double xmin{q->p[0][0]}, xmax{xmin}, ymin{q->p[0][1]}, ymax{ymin};
+		for (int c = 1; c < 4; ++c) {
+			xmin = std::min(xmin, double(q->p[c][0]));
+			xmax = std::max(xmax, double(q->p[c][0]));
+			ymin = std::min(ymin, double(q->p[c][1]));
+			ymax = std::max(ymax, double(q->p[c][1]));
+		}
+		matd_destroy(q->H);
+		matd_destroy(q->Hinv);
+		// the tag white border is outside of the quad.
+		const double margin = std::max(
+		    POOLED_CROP_MARGIN * scale * std::max(xmax - xmin, ymax - ymin),
+		    double(POOLED_CROP_MIN_MARGIN)
+		);
+		const int x0 = std::max(
+		    int(partition.x() + scale * xmin - margin),
+		    0
+		);
+		const int y0 = std::max(
+		    int(partition.y() + scale * ymin - margin),
+		    0
+		);
+		const int x1 = std::min(
+		    int(std::ceil(partition.x() + scale * xmax + margin)),
+		    d_size.width()
+		);
+		const int y1 = std::min(
+		    int(std::ceil(partition.y() + scale * ymax + margin)),
+		    d_size.height()
+		);
+		if (x1 <= x0 || y1 <= y0) {
+			continue;
+		}
+		pool.push_back({
+		    .Partition = j,
+		    .Crop      = Rect{{x0, y0}, {x1 - x0, y1 - y0}},
+		});
 	}
+	d_quads[i] += zarray_size(quads);
+	d_partitionQuads[j] = zarray_size(quads);
+	zarray_destroy(quads);
+}
+
+void ApriltagDetector::decodePooledQuads(size_t i) {
+	if (d_pooledDecode == false || i >= d_task_size) {
+		return;
+	}
+	const auto start   = Time::Now();
+	auto       td      = d_decoders[i].get();
+	size_t     decoded = 0;
+	for (size_t k = d_nextQuad.fetch_add(1); k < d_pool.size();
+	     k        = d_nextQuad.fetch_add(1)) {
+		const auto &crop = d_pool[k].Crop;
+		ImageU8     image{crop.width(), crop.height(), nullptr};
+		d_crops[i].resize(image.NeededSize());
+		image.buffer = d_crops[i].data();
+		ImageU8::Copy(image, d_input.GetROI(crop));
+		if (d_mask != nullptr) {
+			d_mask->Apply(image, crop);
+		}
+		image_u8_t img{
+		    .width  = image.width,
+		    .height = image.height,
+		    .stride = image.stride,
+		    .buf    = image.buffer,
+		};
+		auto detections = apriltag_detector_detect(td, &img);
+		for (int l = 0; l < zarray_size(detections); ++l) {
+			apriltag_detection_t *q;
+			zarray_get(detections, l, &q);
+			auto d = convertDetection(q, crop);
+			if (d_mask != nullptr && d_mask->IsActive(d.X, d.Y) == false) {
+				continue;
+			}
+			d_pooledDetections[k].push_back(d);
+		}
+		apriltag_detections_destroy(detections);
+		++decoded;
+	}
+	if (d_profile != nullptr && decoded > 0) {
+		d_taskProfiles[i].AddStage(
+		    "decode pooled quads",
+		    Time::Now().Sub(start).Seconds()
+		);
+	}
+}
+
+bool ApriltagDetector::copyAndReuseTile(size_t j) {
+	const auto roi   = d_input.GetROI(d_current_partition[j]);
+	auto      &means = d_tileMeans[j];
+	if (d_copyPartitions && d_blurKernel.Empty()) {
+		CopyAndBlockMeans(d_images[j], roi, means);
+	} else {
+		BlockMeans(roi, means);
+	}
+
+	auto &history = d_tileHistory[j];
+	if (history.Age + 1 < d_motionRefreshPeriod &&
+	    MaxAbsDifference(history.Means, means) < d_motionThreshold) {
+		++history.Age;
+		d_detections[j]  = history.Detections;
+		d_reusedTiles[j] = 1;
+		return true;
+	}
+	// blurring is the expensive part, so it is only done if needed.
+	if (d_copyPartitions && d_blurKernel.Empty() == false) {
+		CopyAndBlur(d_images[j], roi, d_blurKernel);
+	}
+	// compared to the last detected frame, so slow drifts are not missed.
+	history.Means.swap(means);
+	history.Age = 0;
+	return false;
 }
 
 void ApriltagDetector::cloneAndDetectPartition(size_t i) {
 	if (i >= d_task_size) {
 		return;
 	}
-	ImageU8::Copy(d_images[i], d_input.GetROI(d_current_partition[i]));
-	image_u8_t img{
-	    .width  = d_images[i].width,
-	    .height = d_images[i].height,
-	    .stride = d_images[i].stride,
-	    .buf    = d_images[i].buffer,
-	};
-	d_detections[i] = apriltag_detector_detect(d_detectors[i].get(), &img);
+	// partitions are pulled by the tasks, so tracked windows of various sizes
+	// are balanced among them.
+	for (size_t j = d_nextPartition.fetch_add(1);
+	     j < d_current_partition.size();
+	     j = d_nextPartition.fetch_add(1)) {
+		const auto start = Time::Now();
+		if (d_gating == true) {
+			if (copyAndReuseTile(j) == true) {
+				if (d_profile != nullptr) {
+					d_taskProfiles[i].Copy += Time::Now().Sub(start).Seconds();
+				}
+				d_quads[i] += d_tileHistory[j].Quads;
+				d_partitionQuads[j] = d_tileHistory[j].Quads;
+				continue;
+			}
+		} else if (d_copyPartitions && d_blurKernel.Empty() == false) {
+			CopyAndBlur(
+			    d_images[j],
+			    d_input.GetROI(d_current_partition[j]),
+			    d_blurKernel
+			);
+		} else if (d_copyPartitions) {
+			ImageU8::Copy(d_images[j], d_input.GetROI(d_current_partition[j]));
+		}
+		if (d_mask != nullptr && d_copyPartitions) {
+			d_mask->Apply(d_images[j], d_current_partition[j]);
+		}
+		if (d_profile != nullptr) {
+			d_taskProfiles[i].Copy += Time::Now().Sub(start).Seconds();
+		}
+		image_u8_t img{
+		    .width  = d_images[j].width,
+		    .height = d_images[j].height,
+		    .stride = d_images[j].stride,
+		    .buf    = d_images[j].buffer,
+		};
+		if (d_pooledDecode) {
+			poolQuads(i, j, &img);
+			d_partitionTimes[j] = Time::Now().Sub(start).Seconds();
+			continue;
+		}
+		auto detections = apriltag_detector_detect(d_detectors[i].get(), &img);
+		if (d_profile != nullptr) {
+			profileStages(i);
+		}
+		// converted here, so the merge node only has to remove duplicates.
+		for (int k = 0; k < zarray_size(detections); ++k) {
+			apriltag_detection_t *q;
+			zarray_get(detections, k, &q);
+			auto d = convertDetection(q, d_current_partition[j]);
+			if (d_mask != nullptr && d_mask->IsActive(d.X, d.Y) == false) {
+				continue;
+			}
+			d_detections[j].push_back(d);
+		}
+		apriltag_detections_destroy(detections);
+		d_quads[i] += d_detectors[i]->nquads;
+		d_partitionQuads[j] = d_detectors[i]->nquads;
+		d_partitionTimes[j] = Time::Now().Sub(start).Seconds();
+		if (d_gating == true) {
+			d_tileHistory[j].Detections = d_detections[j];
+			d_tileHistory[j].Quads      = d_detectors[i]->nquads;
+		}
+	}
+}
+
+void ApriltagDetector::recordCosts() {
+	if (d_costs == nullptr) {
+		return;
+	}
+	for (size_t j = 0; j < d_current_partition.size(); ++j) {
+		d_costs->Record(d_current_partition[j], d_partitionTimes[j]);
+		slog::DTrace(
+		    "partition cost",
+		    slogRect("partition", d_current_partition[j]),
+		    slog::Float("time_s", d_partitionTimes[j]),
+		    slog::Int("quads", d_partitionQuads[j])
+		);
+	}
+	d_costs->Update();
+}
+
+void ApriltagDetector::profileStages(size_t i) {
+	// apriltag clears its profile at the start of each detection, and stamps
+	// the end of each stage.
+	const timeprofile_t *tp   = d_detectors[i]->tp;
+	int64_t              last = tp->utime;
+	for (int k = 0; k < zarray_size(tp->stamps); ++k) {
+		timeprofile_entry stamp;
+		zarray_get(tp->stamps, k, &stamp);
+		d_taskProfiles[i].AddStage(stamp.name, (stamp.utime - last) * 1.0e-6);
+		last = stamp.utime;
+	}
+}
+
+void ApriltagDetector::Profile::Clear() {
+	Copy       = 0.0;
+	Merge      = 0.0;
+	Partitions = 0;
+	Quads      = 0;
+	// stage names are kept, so they are not reallocated at every frame.
+	for (auto &[name, elapsed] : Detect) {
+		elapsed = 0.0;
+	}
+}
+
+void ApriltagDetector::Profile::Add(const Profile &other) {
+	Copy += other.Copy;
+	Merge += other.Merge;
+	Partitions += other.Partitions;
+	Quads += other.Quads;
+	for (const auto &[name, elapsed] : other.Detect) {
+		AddStage(name.c_str(), elapsed);
+	}
+}
+
+void ApriltagDetector::Profile::AddStage(const char *name, double elapsed) {
+	auto it = std::find_if(Detect.begin(), Detect.end(), [name](const auto &s) {
+		return s.first == name;
+	});
+	if (it == Detect.end()) {
+		Detect.push_back({name, elapsed});
+	} else {
+		it->second += elapsed;
+	}
+}
+
+void ApriltagDetector::SetProfile(Profile *profile) {
+	d_profile = profile;
+}
+
+bool ApriltagDetector::NeedsPartitionCopy(const ApriltagOptions &options) {
+	// apriltag only writes to its input when it blurs or sharpens it in place,
+	// which happens if there is no decimation. Otherwise partitions are read
+	// directly from the frame, using its stride.
+	return options.QuadSigma != 0.0 && options.QuadDecimate <= 1.0;
 }
 
 size_t ApriltagDetector::MaxConcurrency() const {
@@ -186,88 +886,63 @@ size_t ApriltagDetector::MaxConcurrency() const {
 
 void ApriltagDetector::SetMaxConcurrency(size_t maxConcurrency) {
 	d_maximumConcurrency.store(
-	    std::clamp(maxConcurrency, size_t(1U), d_partitions.back().size())
+	    std::clamp(maxConcurrency, size_t(1U), d_partitions.size())
 	);
 }
 
+void ApriltagDetector::SetRefineEdges(bool refineEdges) {
+	for (auto &d : d_detectors) {
+		d->refine_edges = refineEdges ? 1 : 0;
+	}
+	for (auto &d : d_decoders) {
+		d->refine_edges = refineEdges ? 1 : 0;
+	}
+}
+
+void ApriltagDetector::SetQuadDecimate(float quadDecimate) {
+	// apriltag blurs the decimated image, and no longer writes to its input.
+	// Partitions are then read from the frame, and apriltag blurs them itself,
+	// so detections are the same as apriltag's for that decimation.
+	d_copyPartitions = d_copyConfigured && quadDecimate <= 1.0f;
+	const bool blurred = d_copyPartitions && d_blurKernel.Empty() == false;
+	for (auto &d : d_detectors) {
+		d->quad_decimate = quadDecimate;
+		d->quad_sigma    = blurred ? 0.0f : d_quadSigma;
+	}
+}
+
 tf::Taskflow &ApriltagDetector::Taskflow() {
 	return d_taskflow;
 }
 
-double ApriltagDetector::computeAngleFromCorner(const apriltag_detection_t *q) {
-	Eigen::Vector2d c0(q->p[0][0], q->p[0][1]);
-	Eigen::Vector2d c1(q->p[1][0], q->p[1][1]);
-	Eigen::Vector2d c2(q->p[2][0], q->p[2][1]);
-	Eigen::Vector2d c3(q->p[3][0], q->p[3][1]);
+double ApriltagDetector::computeAngleFromCorner(const double p[4][2]) {
+	Eigen::Vector2d c0(p[0][0], p[0][1]);
+	Eigen::Vector2d c1(p[1][0], p[1][1]);
+	Eigen::Vector2d c2(p[2][0], p[2][1]);
+	Eigen::Vector2d c3(p[3][0], p[3][1]);
 
 	Eigen::Vector2d delta = (c1 + c2) / 2.0 - (c0 + c3) / 2.0;
 
 	return atan2(delta.y(), delta.x());
 }
 
-std::tuple<uint32_t, double, double, double> ApriltagDetector::convertDetection(
+DetectionMerger::Detection ApriltagDetector::convertDetection(
     const apriltag_detection_t *q, const Rect &roi
 ) {
-	return {
-	    q->id,
-	    q->c[0] + roi.x(),
-	    q->c[1] + roi.y(),
-	    computeAngleFromCorner(q)
+	DetectionMerger::Detection res{
+	    .ID    = uint32_t(q->id),
+	    .X     = q->c[0] + roi.x(),
+	    .Y     = q->c[1] + roi.y(),
+	    .Theta = computeAngleFromCorner(q->p),
 	};
-}
-
-void ApriltagDetector::mergeDetection(
-    const std::vector<zarray_t *> detections,
-    const Partition              &partition,
-    hermes::FrameReadout         &m
-) {
-	typedef std::
-	    vector<Eigen::Vector2d, Eigen::aligned_allocator<Eigen::Vector2d>>
-	        Vector2dList;
-
-	typedef std::map<
-	    uint32_t,
-	    Vector2dList,
-	    std::less<uint32_t>,
-	    Eigen::aligned_allocator<std::pair<const uint32_t, Vector2dList>>>
-	    MapOfPoints;
-
-	MapOfPoints points;
-
-	apriltag_detection_t *q;
-	size_t                i = -1;
-	for (const auto &localDetections : detections) {
-		if (localDetections == nullptr) {
-			continue;
-		}
-		const auto &roi = partition[++i];
-		for (int j = 0; j < zarray_size(localDetections); ++j) {
-			zarray_get(localDetections, j, &q);
-			const auto &[tagID, x, y, angle] = convertDetection(q, roi);
-			Eigen::Vector2d currentPoint{x, y};
-			auto            fi = std::find_if(
-                points[tagID].cbegin(),
-                points[tagID].cend(),
-                [this, &currentPoint](const Eigen::Vector2d &p) {
-                    return (currentPoint - p).squaredNorm() <
-                           d_minimumDetectionDistanceSquared;
-                }
-            );
-			if (fi != points[tagID].cend()) {
-				continue;
-			}
-			points[tagID].push_back(currentPoint);
-
-			auto t = m.add_tags();
-			t->set_id(tagID);
-			t->set_x(x);
-			t->set_y(y);
-			t->set_theta(angle);
-		}
+	for (size_t i = 0; i < 4; ++i) {
+		res.Corners[i][0] = q->p[i][0] + roi.x();
+		res.Corners[i][1] = q->p[i][1] + roi.y();
 	}
+	return res;
 }
 
-ApriltagDetector::FamilyPtr ApriltagDetector::createFamily(tags::Family family
+ApriltagDetector::FamilyPtr ApriltagDetector::CreateFamily(tags::Family family
 ) {
 	typedef apriltag_family_t *(*FamilyConstructor)();
 	typedef void (*FamilyDestructor)(apriltag_family_t *);
@@ -307,11 +982,21 @@ ApriltagDetector::FamilyPtr ApriltagDetector::createFamily(tags::Family family
 	return {std::get<0>(f)(), std::get<1>(f)};
 }
 
+QuickDecodeTable::Ptr ApriltagDetector::loadDecodeTable(
+    apriltag_family_t *family, const ApriltagOptions &options
+) {
+	auto cacheDir = options.DecodeCacheDir();
+	if (cacheDir.empty()) {
+		return QuickDecodeTable::Build(family, DECODE_BITS_CORRECTED);
+	}
+	return QuickDecodeTable::Load(family, DECODE_BITS_CORRECTED, cacheDir);
+}
+
 ApriltagDetector::DetectorPtr ApriltagDetector::createDetector(
-    const ApriltagOptions &options, apriltag_family_t *family
+    const ApriltagOptions &options, const QuickDecodeTable &decodeTable
 ) {
 	auto d = apriltag_detector_create();
-	apriltag_detector_add_family(d, family);
+	decodeTable.Attach(d);
 	d->nthreads                 = 1;
 	d->quad_decimate            = options.QuadDecimate;
 	d->quad_sigma               = options.QuadSigma;
@@ -324,14 +1009,45 @@ ApriltagDetector::DetectorPtr ApriltagDetector::createDetector(
 	d->qtp.min_white_black_diff = options.QuadMinBWDiff;
 	d->qtp.deglitch             = options.QuadDeglitch ? 1 : 0;
 
-	return DetectorPtr(d, apriltag_detector_destroy);
+	return DetectorPtr(d, destroyDetector);
+}
+
+void ApriltagDetector::destroyDetector(apriltag_detector_t *detector) {
+	QuickDecodeTable::Detach(detector);
+	apriltag_detector_destroy(detector);
 }
 
 void ApriltagDetector::SetInputOutput(
-    const ImageU8 &image, hermes::FrameReadout *readout
+    const ImageU8        &image,
+    hermes::FrameReadout *readout,
+    const Partition      *rois
 ) {
-	d_input   = image;
-	d_readout = readout;
+	d_input         = image;
+	d_readout       = readout;
+	d_rois          = rois;
+	d_verifyWorkers = d_maximumConcurrency.load();
+}
+
+void ApriltagDetector::skipVerifiedTags() {
+	d_verified.clear();
+	if (d_verifier == nullptr || d_rois == nullptr) {
+		return;
+	}
+	d_lost.clear();
+	d_verifier->Collect(d_verified, d_lost);
+	for (auto &d : d_verified) {
+		d.Theta = computeAngleFromCorner(d.Corners);
+	}
+
+	d_unverifiedROIs.clear();
+	d_verifier->SelectWindows(*d_rois, d_unverifiedROIs);
+	slog::DDebug(
+	    "verified tracked tags",
+	    slog::Int("verified", d_verified.size()),
+	    slog::Int("lost", d_lost.size()),
+	    slog::Int("windows", d_unverifiedROIs.size())
+	);
+	d_rois = &d_unverifiedROIs;
 }
 
 } // namespace artemis
@@ -10,7 +10,12 @@
 
 #include "ImageU8.hpp"
 #include "Options.hpp"
+#include "QuadVerifier.hpp"
+#include "QuickDecodeTable.hpp"
 
+#include "utils/DetectionMask.hpp"
+#include "utils/DetectionMerger.hpp"
+#include "utils/ImageKernels.hpp"
 #include "utils/Partitions.hpp"
 
 #include "Rect.hpp"
@@ -20,6 +25,44 @@ namespace artemis {
 
 class ApriltagDetector {
 public:
+	typedef std::unique_ptr<apriltag_family_t, void (*)(apriltag_family_t *)>
+	    FamilyPtr;
+
+	constexpr static int PARTITION_MARGIN = 75;
+	// same default than apriltag_detector_add_family().
+	constexpr static int DECODE_BITS_CORRECTED = 2;
+	// resolution and smoothing of the measured detection cost, used by
+	// adaptive partitions.
+	constexpr static int    COST_CELL_SIZE = 128;
+	constexpr static double COST_SMOOTHING = 0.1;
+	// adaptive partitions are not equal, so they need more buffer.
+	constexpr static double ADAPTIVE_BUFFER_SLACK = 1.25;
+	// maximal motion of a tracked tag corner the verifier searches for.
+	constexpr static int VERIFY_SEARCH_RADIUS = 8;
+	// margin around a pooled quad, relative to its size, for its decoding.
+	constexpr static double POOLED_CROP_MARGIN     = 0.25;
+	constexpr static int    POOLED_CROP_MIN_MARGIN = 8;
+
+	// Returns true if apriltag may modify the image it detects on, and
+	// therefore needs a copy of the partitions.
+	static bool NeedsPartitionCopy(const ApriltagOptions &options);
+
+	static FamilyPtr CreateFamily(tags::Family family);
+
+	// Time spent in each phase of a run, in seconds. Copy and detection are
+	// summed over partitions, so they exceed the run time when parallel.
+	struct Profile {
+		double Copy = 0.0, Merge = 0.0;
+		// apriltag timeprofile stages, in execution order.
+		std::vector<std::pair<std::string, double>> Detect;
+		size_t                                      Partitions = 0;
+		size_t                                      Quads      = 0;
+
+		void Clear();
+		void Add(const Profile &other);
+		void AddStage(const char *name, double elapsed);
+	};
+
 	ApriltagDetector(
 	    size_t maxParallel, const Size &size, const ApriltagOptions &options
 	);
@@ -28,31 +71,44 @@ public:
 
 	size_t MaxConcurrency() const;
 	void   SetMaxConcurrency(size_t maxConcurrency);
-	void   SetInputOutput(const ImageU8 &image, hermes::FrameReadout *readout);
+
+	// Overrides the detection parameters of the next runs, to trade accuracy
+	// for speed. Must not be called while the taskflow runs.
+	void SetRefineEdges(bool refineEdges);
+	void SetQuadDecimate(float quadDecimate);
+
+	// If profile is not null, the next runs fill it with their timings. It
+	// must stay valid until profiling is disabled with a null profile.
+	void SetProfile(Profile *profile);
+
+	// Sets the input and output of the next run. If rois is not null, only
+	// these regions are processed instead of the full frame. rois must stay
+	// valid until the run completes.
+	void SetInputOutput(
+	    const ImageU8        &image,
+	    hermes::FrameReadout *readout,
+	    const Partition      *rois = nullptr
+	);
 
 private:
-	typedef std::unique_ptr<apriltag_family_t, void (*)(apriltag_family_t *)>
-	    FamilyPtr;
 	typedef std::
 	    unique_ptr<apriltag_detector_t, void (*)(apriltag_detector_t *)>
 	        DetectorPtr;
 
-	static FamilyPtr createFamily(tags::Family family);
-	static DetectorPtr
-	createDetector(const ApriltagOptions &options, apriltag_family_t *family);
+	static QuickDecodeTable::Ptr
+	loadDecodeTable(apriltag_family_t *family, const ApriltagOptions &options);
+	static DetectorPtr createDetector(
+	    const ApriltagOptions &options, const QuickDecodeTable &decodeTable
+	);
+	static void destroyDetector(apriltag_detector_t *detector);
 
-	static double computeAngleFromCorner(const apriltag_detection_t *q);
+	static double computeAngleFromCorner(const double p[4][2]);
 
-	static std::tuple<uint32_t, double, double, double>
+	static DetectionMerger::Detection
 	convertDetection(const apriltag_detection_t *q, const Rect &roi);
 
-	void mergeDetection(
-	    const std::vector<zarray_t *> detections,
-	    const Partition              &partition,
-	    hermes::FrameReadout         &m
-	);
-
 	FamilyPtr                d_family;
+	QuickDecodeTable::Ptr    d_decodeTable;
 	std::vector<DetectorPtr> d_detectors;
 	std::vector<Partition>   d_partitions;
 
@@ -95,19 +151,97 @@ private:
 	};
 
 	void setUpTaskflow();
+	// Removes the tracked windows without any tag lost by the verifier.
+	void skipVerifiedTags();
+	void planPartitions();
+	// Returns the area of rect that is not masked.
+	double activeArea(const Rect &rect) const;
+	// Adds the margins or the border strips to the tiles of bounds.
+	void addOverlap(const Rect &bounds, Partition &tiles) const;
+	// Shrinks rects to their active bounds, and removes the masked ones.
+	void applyMask(Partition &rects) const;
+	bool allocateImages();
+	void resetTileHistory();
 	void cloneAndDetectPartition(size_t i);
+	// Finds the quads of partition j with detector i, and pools them.
+	void poolQuads(size_t i, size_t j, image_u8_t *image);
+	// Decodes the pooled quads pulled by worker i.
+	void decodePooledQuads(size_t i);
+	// Copies partition j and computes its block means. Returns true if the
+	// partition did not change since its last detection, and reused it.
+	bool copyAndReuseTile(size_t j);
+	void recordCosts();
+	// Adds the stages stamped by apriltag on detector i to the task profile.
+	void profileStages(size_t i);
 
 	ImageU8               d_input;
 	hermes::FrameReadout *d_readout = nullptr;
+	const Partition      *d_rois    = nullptr;
 
 	Buffer d_buffer;
 
+	Size                    d_size;
+	// partitions are only copied and blurred at the configured decimation.
+	bool                    d_copyConfigured;
+	bool                    d_copyPartitions;
+	float                   d_quadSigma;
+	GaussianKernel          d_blurKernel;
+	size_t                  d_tilesPerTask;
+	int                     d_stitchHalfWidth;
 	size_t                  d_task_size = 0;
 	Partition               d_current_partition;
 	std::vector<ImageU8>    d_images;
-	std::vector<zarray_t *> d_detections;
+	std::vector<DetectionMerger::List> d_detections;
+	std::vector<size_t>     d_quads;
+	std::atomic<size_t>     d_nextPartition;
+
+	// quads found in a partition, decoded in a crop of the frame around them.
+	struct PooledQuad {
+		size_t Partition;
+		Rect   Crop;
+	};
+
+	bool                                 d_pooledDecode;
+	std::vector<DetectorPtr>             d_decoders;
+	std::vector<std::vector<PooledQuad>> d_partitionPools;
+	std::vector<PooledQuad>              d_pool;
+	std::vector<DetectionMerger::List>   d_pooledDetections;
+	std::vector<std::vector<uint8_t>>    d_crops;
+	std::atomic<size_t>                  d_nextQuad;
+
+	std::unique_ptr<QuadVerifier> d_verifier;
+	size_t                        d_verifyWorkers = 0;
+	DetectionMerger::List         d_verified;
+	std::vector<Eigen::Vector2d>  d_lost;
+	Partition                     d_unverifiedROIs;
+
+	// last detection of each full frame tile, reused until motion is seen.
+	struct TileHistory {
+		std::vector<uint8_t>  Means;
+		DetectionMerger::List Detections;
+		size_t                Quads = 0;
+		size_t                Age   = 0;
+	};
+
+	int                               d_motionThreshold;
+	size_t                            d_motionRefreshPeriod;
+	bool                              d_gating = false;
+	Partition                         d_gatedPartition;
+	std::vector<TileHistory>          d_tileHistory;
+	std::vector<std::vector<uint8_t>> d_tileMeans;
+	std::vector<uint8_t>              d_reusedTiles;
+
+	DetectionMask::Ptr       d_mask;
+	std::unique_ptr<CostMap> d_maskCosts;
+
+	std::unique_ptr<CostMap> d_costs;
+	std::vector<double>      d_partitionTimes;
+	std::vector<size_t>      d_partitionQuads;
+
+	Profile             *d_profile = nullptr;
+	std::vector<Profile> d_taskProfiles;
 
-	double                d_minimumDetectionDistanceSquared;
+	DetectionMerger       d_merger;
 	std::atomic<uint32_t> d_maximumConcurrency;
 	tf::Taskflow          d_taskflow;
 };
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include "ApriltagDetector.hpp"
+#include "SyntheticFrameGrabber.hpp"
+
+#include <apriltag/apriltag.h>
+#include <apriltag/tag36h11.h>
+
+#include <map>
+
+namespace fort {
+namespace artemis {
+
+class ApriltagDetectorTest : public ::testing::Test {
+protected:
+	void SetUp() {
+		d_synthetic.Tags    = 4;
+		d_synthetic.Width   = 640;
+		d_synthetic.Height  = 480;
+		d_synthetic.TagSize = 60;
+		d_synthetic.Seed    = 42;
+
+		d_options.family        = "36h11";
+		d_options.NoDecodeCache = true;
+		d_options.QuadSigma     = 0.8;
+	}
+
+	// Returns the tag centers found by apriltag alone on the whole image.
+	std::map<uint32_t, Eigen::Vector2d>
+	detect(const ImageU8 &image, float quadDecimate, float quadSigma) {
+		auto family = tag36h11_create();
+		auto td     = apriltag_detector_create();
+		apriltag_detector_add_family_bits(
+		    td,
+		    family,
+		    ApriltagDetector::DECODE_BITS_CORRECTED
+		);
+		td->nthreads      = 1;
+		td->quad_decimate = quadDecimate;
+		td->quad_sigma    = quadSigma;
+
+		image_u8_t img{
+		    .width  = image.width,
+		    .height = image.height,
+		    .stride = image.stride,
+		    .buf    = image.buffer,
+		};
+		auto detections = apriltag_detector_detect(td, &img);
+		std::map<uint32_t, Eigen::Vector2d> res;
+		for (int i = 0; i < zarray_size(detections); ++i) {
+			apriltag_detection_t *d;
+			zarray_get(detections, i, &d);
+			res[d->id] = {d->c[0], d->c[1]};
+		}
+		apriltag_detections_destroy(detections);
+		apriltag_detector_destroy(td);
+		tag36h11_destroy(family);
+		return res;
+	}
+
+	// Draws a tag36h11, white border included, centered on (x,y) with
+	// `scale` pixels per module.
+	void render(ImageU8 &image, uint32_t ID, int x, int y, int scale) {
+		auto family = tag36h11_create();
+		auto tag    = apriltag_to_image(family, ID);
+		int  x0     = x - tag->width * scale / 2;
+		int  y0     = y - tag->height * scale / 2;
+		for (int iy = 0; iy < tag->height * scale; ++iy) {
+			for (int ix = 0; ix < tag->width * scale; ++ix) {
+				image.buffer[(y0 + iy) * image.stride + x0 + ix] =
+				    tag->buf[(iy / scale) * tag->stride + ix / scale];
+			}
+		}
+		image_u8_destroy(tag);
+		tag36h11_destroy(family);
+	}
+
+	SyntheticOptions d_synthetic;
+	ApriltagOptions  d_options;
+};
+
+TEST_F(ApriltagDetectorTest, RaisedDecimationMatchesApriltag) {
+	SyntheticFrameGrabber grabber{d_synthetic, 0.0};
+	ASSERT_TRUE(ApriltagDetector::NeedsPartitionCopy(d_options));
+	// a single partition covering the whole frame.
+	ApriltagDetector detector{1, grabber.Resolution(), d_options};
+	tf::Executor     executor{1};
+
+	grabber.Start();
+	auto frame = grabber.NextFrame();
+	for (float quadDecimate : {2.0f, 1.0f}) {
+		detector.SetQuadDecimate(quadDecimate);
+		hermes::FrameReadout readout;
+		detector.SetInputOutput(frame->ToImageU8(), &readout);
+		executor.run(detector.Taskflow()).wait();
+
+		// without decimation, apriltag blurs the frame in place, so it runs
+		// last.
+		const auto expected =
+		    detect(frame->ToImageU8(), quadDecimate, d_options.QuadSigma);
+		ASSERT_EQ(expected.size(), d_synthetic.Tags);
+
+		ASSERT_EQ(size_t(readout.tags_size()), expected.size());
+		for (const auto &tag : readout.tags()) {
+			ASSERT_EQ(expected.count(tag.id()), 1) << "tag " << tag.id();
+			const auto &center = expected.at(tag.id());
+			if (quadDecimate > 1.0f) {
+				// same computation as apriltag.
+				EXPECT_DOUBLE_EQ(tag.x(), center.x()) << "tag " << tag.id();
+				EXPECT_DOUBLE_EQ(tag.y(), center.y()) << "tag " << tag.id();
+			} else {
+				// blurred by artemis while copied, with its own rounding.
+				EXPECT_NEAR(tag.x(), center.x(), 0.5) << "tag " << tag.id();
+				EXPECT_NEAR(tag.y(), center.y(), 0.5) << "tag " << tag.id();
+			}
+		}
+	}
+}
+
+TEST_F(ApriltagDetectorTest, StitchingMatchesMargins) {
+	// four 320x240 tiles, their borders cross at (320,240).
+	const Size size{640, 480};
+	// tag centers
+	const std::map<uint32_t, Eigen::Vector2i> tags = {
+	    {0, {320, 100}}, // across the vertical border
+	    {1, {120, 240}}, // across the horizontal border
+	    {2, {320, 240}}, // on the corner of all tiles
+	    {3, {150, 225}}, // off-center across the horizontal border
+	    {4, {500, 380}}, // inside a single tile
+	};
+	std::vector<uint8_t> buffer(size.width() * size.height(), 160);
+	ImageU8 image{size.width(), size.height(), buffer.data(), size.width()};
+	for (const auto &[ID, center] : tags) {
+		// 50 pixels wide, smaller than the stitching half-width.
+		render(image, ID, center.x(), center.y(), 5);
+	}
+
+	d_options.TilesPerWorker = 4;
+	auto found = [&](int stitchHalfWidth) {
+		d_options.StitchHalfWidth = stitchHalfWidth;
+		ApriltagDetector     detector{1, size, d_options};
+		tf::Executor         executor{1};
+		hermes::FrameReadout readout;
+		detector.SetInputOutput(image, &readout);
+		executor.run(detector.Taskflow()).wait();
+		std::map<uint32_t, Eigen::Vector2d> res;
+		for (const auto &tag : readout.tags()) {
+			EXPECT_EQ(res.count(tag.id()), 0) << "duplicated tag " << tag.id();
+			res[tag.id()] = {tag.x(), tag.y()};
+		}
+		return res;
+	};
+
+	const auto withMargins   = found(0);
+	const auto withStitching = found(64);
+	ASSERT_EQ(withMargins.size(), tags.size());
+	ASSERT_EQ(withStitching.size(), tags.size());
+	for (const auto &[ID, center] : tags) {
+		ASSERT_EQ(withMargins.count(ID), 1) << "tag " << ID;
+		ASSERT_EQ(withStitching.count(ID), 1) << "tag " << ID;
+		const auto &expected = withMargins.at(ID);
+		const auto &actual   = withStitching.at(ID);
+		// the thresholding grid depends on the detected region's origin.
+		EXPECT_NEAR(actual.x(), expected.x(), 0.5) << "tag " << ID;
+		EXPECT_NEAR(actual.y(), expected.y(), 0.5) << "tag " << ID;
+		EXPECT_NEAR(expected.x(), center.x(), 1.0) << "tag " << ID;
+		EXPECT_NEAR(expected.y(), center.y(), 1.0) << "tag " << ID;
+	}
+}
+
+TEST_F(ApriltagDetectorTest, PooledDecodeMatchesDetection) {
+	d_synthetic.Tags         = 12;
+	d_options.TilesPerWorker = 2;
+	SyntheticFrameGrabber grabber{d_synthetic, 0.0};
+	tf::Executor          executor{2};
+
+	auto found = [&](bool pooled, const ImageU8 &image) {
+		d_options.PooledDecode = pooled;
+		ApriltagDetector     detector{2, grabber.Resolution(), d_options};
+		hermes::FrameReadout readout;
+		detector.SetInputOutput(image, &readout);
+		executor.run(detector.Taskflow()).wait();
+		std::map<uint32_t, Eigen::Vector2d> res;
+		for (const auto &tag : readout.tags()) {
+			EXPECT_EQ(res.count(tag.id()), 0) << "duplicated tag " << tag.id();
+			res[tag.id()] = {tag.x(), tag.y()};
+		}
+		return res;
+	};
+
+	grabber.Start();
+	for (int i = 0; i < 3; ++i) {
+		auto       frame    = grabber.NextFrame();
+		const auto expected = found(false, frame->ToImageU8());
+		const auto pooled   = found(true, frame->ToImageU8());
+		ASSERT_EQ(expected.size(), d_synthetic.Tags);
+		ASSERT_EQ(pooled.size(), expected.size());
+		for (const auto &[ID, center] : expected) {
+			ASSERT_EQ(pooled.count(ID), 1) << "tag " << ID;
+			// decoded in a crop of the frame, blurred by apriltag.
+			EXPECT_NEAR(pooled.at(ID).x(), center.x(), 0.5) << "tag " << ID;
+			EXPECT_NEAR(pooled.at(ID).y(), center.y(), 0.5) << "tag " << ID;
+		}
+	}
+}
+
+} // namespace artemis
+} // namespace fort
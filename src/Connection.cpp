@@ -19,6 +19,8 @@
 
 #include <fort/utils/Defer.hpp>
 
+#include "FrameLatency.hpp"
+
 namespace fort {
 namespace artemis {
 using namespace std::chrono_literals;
@@ -131,8 +133,8 @@ void Connection::mainLoopDispatch() {
 			    slog::Int("size", d_queue.size_approx())
 			);
 
-			std::string buf;
-			while (d_queue.try_dequeue(buf)) {
+			Message message;
+			while (d_queue.try_dequeue(message)) {
 			}
 		}
 
@@ -257,11 +259,11 @@ void Connection::sendNextBuffer() {
 
 	struct WriteData {
 		Connection *self;
-		std::string buffer;
+		Message     message;
 	};
 
 	auto write = std::make_unique<WriteData>(WriteData{.self = this});
-	if (d_queue.try_dequeue(write->buffer) == false) {
+	if (d_queue.try_dequeue(write->message) == false) {
 		return;
 	}
 
@@ -269,7 +271,7 @@ void Connection::sendNextBuffer() {
 
 	d_logger.DDebug(
 	    "writing",
-	    slog::Int("total", write->buffer.size()),
+	    slog::Int("total", write->message.Buffer.size()),
 	    slog::Int("txID", d_txID.fetch_add(1) + 1)
 	);
 
@@ -292,8 +294,8 @@ void Connection::sendNextBuffer() {
 	incrementRefcount();
 
 	// we will release in the call, so we need to copy buffer data now.
-	auto data = write->buffer.data();
-	auto size = write->buffer.size();
+	auto data = write->message.Buffer.data();
+	auto size = write->message.Buffer.size();
 
 	g_output_stream_write_all_async(
 	    d_stream,
@@ -344,6 +346,19 @@ void Connection::sendNextBuffer() {
 			    return;
 		    }
 		    logger.DDebug("written", slog::Int("bytes", written));
+		    if (w->self->d_latency != nullptr) {
+			    const auto now = Time::Now();
+			    w->self->d_latency->Record(
+			        FrameLatency::Stage::Send,
+			        w->message.Posted,
+			        now
+			    );
+			    w->self->d_latency->Record(
+			        FrameLatency::Stage::Total,
+			        w->message.Acquired,
+			        now
+			    );
+		    }
 		    w->self->d_state.store(State::CONNECTED);
 		    // we reschedule a dispatch to either push next write or
 		    // continue the closing.
@@ -353,14 +368,24 @@ void Connection::sendNextBuffer() {
 	);
 }
 
-inline std::string serialize(const google::protobuf::MessageLite &m) {
+std::string Connection::Serialize(const google::protobuf::MessageLite &m) {
 	std::ostringstream oss;
 	google::protobuf::util::SerializeDelimitedToOstream(m, &oss);
 	return oss.str();
 }
 
+size_t Connection::QueueSize() const {
+	return d_queue.size_approx();
+}
+
+void Connection::SetLatency(const std::shared_ptr<FrameLatency> &latency) {
+	d_latency = latency;
+}
+
 bool Connection::PostMessage(
-    const google::protobuf::MessageLite &m, uint64_t frameID
+    const google::protobuf::MessageLite &m,
+    uint64_t                             frameID,
+    const std::optional<Time>           &acquired
 ) {
 	auto logger = slog::With(slog::Int("frameID", frameID));
 
@@ -386,8 +411,12 @@ bool Connection::PostMessage(
 		return false;
 	}
 
-	auto serialized = serialize(m);
-	if (d_queue.enqueue(serialized) == false) {
+	Message message{
+	    .Buffer   = Serialize(m),
+	    .Acquired = acquired,
+	    .Posted   = Time::Now(),
+	};
+	if (d_queue.enqueue(std::move(message)) == false) {
 		logger.Error(
 		    "queue could not serialize",
 		    slog::String("message", m.ShortDebugString()),
@@ -2,6 +2,8 @@
 
 #include <atomic>
 #include <concurrentqueue.h>
+#include <memory>
+#include <optional>
 
 #include <google/protobuf/message.h>
 
@@ -15,6 +17,8 @@
 namespace fort {
 namespace artemis {
 
+class FrameLatency;
+
 class Connection {
 public:
 	~Connection();
@@ -33,11 +37,33 @@ public:
 
 	void Close();
 
-	// thread-safe function
-	bool PostMessage(const google::protobuf::MessageLite &m, uint64_t frameID);
+	// Records the network time of the messages in latency. Must be called
+	// before the first message is posted.
+	void SetLatency(const std::shared_ptr<FrameLatency> &latency);
+
+	// thread-safe function. If acquired is set, the time from acquired to the
+	// completion of the write is recorded.
+	bool PostMessage(
+	    const google::protobuf::MessageLite &m,
+	    uint64_t                             frameID,
+	    const std::optional<Time>           &acquired = std::nullopt
+	);
+
+	// Returns the approximate number of messages waiting to be sent.
+	// Thread-safe.
+	size_t QueueSize() const;
+
+	// Returns m as a size delimited message, as sent on the wire.
+	static std::string Serialize(const google::protobuf::MessageLite &m);
 
 private:
-	using Queue = moodycamel::ConcurrentQueue<std::string>;
+	struct Message {
+		std::string         Buffer;
+		std::optional<Time> Acquired;
+		Time                Posted;
+	};
+
+	using Queue = moodycamel::ConcurrentQueue<Message>;
 
 	static gboolean mainLoopDispatchCb(gpointer userdata);
 	void            mainLoopDispatch();
@@ -67,7 +93,8 @@ private:
 
 	guint d_reconnectionSource{0};
 
-	Queue d_queue;
+	Queue                         d_queue;
+	std::shared_ptr<FrameLatency> d_latency;
 
 	enum class State {
 		INITIAL,
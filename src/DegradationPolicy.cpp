@@ -0,0 +1,53 @@
+#include "DegradationPolicy.hpp"
+
+#include <stdexcept>
+
+namespace fort {
+namespace artemis {
+
+DegradationPolicy::DegradationPolicy(const Config &config)
+    : d_config{config} {
+	if (d_config.Period <= 0.0) {
+		throw std::invalid_argument("camera period must be positive");
+	}
+	if (d_config.Levels == 0) {
+		throw std::invalid_argument("at least one level is needed");
+	}
+	if (d_config.LowLoad >= d_config.HighLoad) {
+		throw std::invalid_argument("low load must be smaller than high load");
+	}
+}
+
+size_t DegradationPolicy::Update(double processing) {
+	const double load = processing / d_config.Period;
+	if (d_measured == false) {
+		d_measured = true;
+		d_load     = load;
+	} else {
+		d_load += d_config.Smoothing * (load - d_load);
+	}
+
+	if (++d_held < d_config.HoldFrames) {
+		return d_level;
+	}
+
+	if (d_load > d_config.HighLoad && d_level + 1 < d_config.Levels) {
+		++d_level;
+		d_held = 0;
+	} else if (d_load < d_config.LowLoad && d_level > 0) {
+		--d_level;
+		d_held = 0;
+	}
+	return d_level;
+}
+
+size_t DegradationPolicy::Level() const {
+	return d_level;
+}
+
+double DegradationPolicy::Load() const {
+	return d_load;
+}
+
+} // namespace artemis
+} // namespace fort
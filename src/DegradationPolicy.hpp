@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+
+namespace fort {
+namespace artemis {
+
+// Chooses how much the processing should be degraded from the measured
+// processing time of each frame against the camera period. Levels are raised
+// one at a time when the smoothed load is too high, and lowered when it stays
+// low. Both changes wait for the load to reflect the previous one.
+class DegradationPolicy {
+public:
+	struct Config {
+		// camera period in seconds.
+		double Period;
+		// number of levels, 0 is no degradation.
+		size_t Levels;
+		// load above which the level is raised.
+		double HighLoad = 0.9;
+		// load below which the level is lowered.
+		double LowLoad = 0.6;
+		// exponential smoothing of the load.
+		double Smoothing = 0.1;
+		// minimal number of frames between two level changes.
+		size_t HoldFrames = 16;
+	};
+
+	DegradationPolicy(const Config &config);
+
+	// Records the processing time of the last frame, in seconds, and returns
+	// the level for the next one.
+	size_t Update(double processing);
+
+	size_t Level() const;
+
+	// smoothed ratio of the processing time over the camera period.
+	double Load() const;
+
+private:
+	Config d_config;
+	size_t d_level    = 0;
+	size_t d_held     = 0;
+	double d_load     = 0.0;
+	bool   d_measured = false;
+};
+
+} // namespace artemis
+} // namespace fort
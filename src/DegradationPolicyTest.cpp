@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "DegradationPolicy.hpp"
+
+namespace fort {
+namespace artemis {
+
+class DegradationPolicyTest : public ::testing::Test {};
+
+TEST_F(DegradationPolicyTest, RaisesAndLowersWithHysteresis) {
+	DegradationPolicy policy{{
+	    .Period     = 0.1,
+	    .Levels     = 3,
+	    .HighLoad   = 0.9,
+	    .LowLoad    = 0.6,
+	    .Smoothing  = 0.5,
+	    .HoldFrames = 4,
+	}};
+
+	// loads between the thresholds never change the level.
+	for (size_t i = 0; i < 20; ++i) {
+		EXPECT_EQ(policy.Update(0.08), 0);
+	}
+
+	// the level is raised as soon as the load is too high, then only once
+	// the hold period is over.
+	EXPECT_EQ(policy.Update(0.2), 1);
+	for (size_t i = 0; i < 3; ++i) {
+		EXPECT_EQ(policy.Update(0.2), 1);
+	}
+	EXPECT_EQ(policy.Update(0.2), 2);
+	// the last level is never exceeded.
+	for (size_t i = 0; i < 20; ++i) {
+		EXPECT_EQ(policy.Update(0.2), 2);
+	}
+
+	// the smoothed load takes a few frames to go below the low threshold.
+	EXPECT_EQ(policy.Update(0.01), 2);
+	EXPECT_GT(policy.Load(), 0.6);
+	EXPECT_EQ(policy.Update(0.01), 1);
+	EXPECT_LT(policy.Load(), 0.6);
+	for (size_t i = 0; i < 3; ++i) {
+		EXPECT_EQ(policy.Update(0.01), 1);
+	}
+	EXPECT_EQ(policy.Update(0.01), 0);
+	EXPECT_EQ(policy.Level(), 0);
+}
+
+TEST_F(DegradationPolicyTest, ChecksConfig) {
+	EXPECT_THROW(
+	    DegradationPolicy({.Period = 0.0, .Levels = 2}),
+	    std::invalid_argument
+	);
+	EXPECT_THROW(
+	    DegradationPolicy({.Period = 0.1, .Levels = 0}),
+	    std::invalid_argument
+	);
+	EXPECT_THROW(
+	    DegradationPolicy(
+	        {.Period = 0.1, .Levels = 2, .HighLoad = 0.5, .LowLoad = 0.5}
+	    ),
+	    std::invalid_argument
+	);
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,72 @@
+#include "FrameLatency.hpp"
+
+#include <slog++/slog++.hpp>
+
+namespace fort {
+namespace artemis {
+
+const char *FrameLatency::StageName(Stage stage) {
+	switch (stage) {
+	case Stage::Queue:
+		return "queue";
+	case Stage::Wait:
+		return "wait";
+	case Stage::Detect:
+		return "detect";
+	case Stage::Output:
+		return "output";
+	case Stage::Send:
+		return "send";
+	case Stage::Total:
+		return "total";
+	}
+	return "unknown";
+}
+
+FrameLatency::FrameLatency(const Duration &reportPeriod)
+    : d_period{reportPeriod}
+    , d_logger{slog::With(slog::String("task", "latency"))} {}
+
+void FrameLatency::Record(
+    Stage stage, const std::optional<Time> &start, const Time &end
+) {
+	if (start.has_value() == false) {
+		return;
+	}
+	d_histograms[size_t(stage)].Record(end.Sub(start.value()));
+}
+
+void FrameLatency::Report(const Time &now) {
+	if (d_last.has_value() == false) {
+		d_last = now;
+		return;
+	}
+	if (now.Sub(d_last.value()) < d_period) {
+		return;
+	}
+	d_last = now;
+
+	for (size_t i = 0; i < NUM_STAGES; ++i) {
+		auto       current  = d_histograms[i].Read();
+		const auto snapshot = current.Since(d_reported[i]);
+		d_reported[i]       = std::move(current);
+		if (snapshot.Count() == 0) {
+			continue;
+		}
+		d_logger.Info(
+		    "frame latency",
+		    slog::String("stage", StageName(Stage(i))),
+		    slog::Int("frames", snapshot.Count()),
+		    slog::Float("p50_ms", snapshot.Percentile(50).Milliseconds()),
+		    slog::Float("p99_ms", snapshot.Percentile(99).Milliseconds()),
+		    slog::Float("max_ms", snapshot.Max().Milliseconds())
+		);
+	}
+}
+
+LatencyHistogram::Snapshot FrameLatency::Read(Stage stage) const {
+	return d_histograms[size_t(stage)].Read();
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <optional>
+
+#include <fort/time/Time.hpp>
+
+#include <slog++/Logger.hpp>
+
+#include "utils/LatencyHistogram.hpp"
+
+namespace fort {
+namespace artemis {
+
+// Accounts where frames spend their time, from their acquisition to the
+// completion of the network write of their readout. Stages are recorded
+// concurrently by the tasks, and periodically logged.
+class FrameLatency {
+public:
+	enum class Stage : size_t {
+		// from acquisition to the dequeue by the process task.
+		Queue = 0,
+		// from dequeue to the start of detection, waiting for a slot or a
+		// detector.
+		Wait,
+		Detect,
+		// from the end of detection to the readout posted to the connection.
+		Output,
+		// from posting to the completion of the network write.
+		Send,
+		// from acquisition to the completion of the network write.
+		Total,
+	};
+
+	constexpr static size_t NUM_STAGES = size_t(Stage::Total) + 1;
+
+	static const char *StageName(Stage stage);
+
+	FrameLatency(const Duration &reportPeriod);
+
+	// Records start to end for stage, if start was stamped. Thread-safe.
+	void
+	Record(Stage stage, const std::optional<Time> &start, const Time &end);
+
+	// Logs the stages recorded since the last report, if the report period
+	// elapsed. Must be called from a single thread.
+	void Report(const Time &now);
+
+	// Returns everything recorded for stage. Thread-safe.
+	LatencyHistogram::Snapshot Read(Stage stage) const;
+
+private:
+	std::array<LatencyHistogram, NUM_STAGES>           d_histograms;
+	std::array<LatencyHistogram::Snapshot, NUM_STAGES> d_reported;
+	Duration                                 d_period;
+	std::optional<Time>                      d_last;
+	slog::Logger<1>                          d_logger;
+};
+
+} // namespace artemis
+} // namespace fort
@@ -45,8 +45,14 @@ void ImageU8::Copy(ImageU8 &dst, const ImageU8 &src, tf::Runtime *rt) {
 	if (dst.width != src.width || dst.height != src.height) {
 		throw std::invalid_argument("Sizes must match");
 	}
-	if (dst.stride == src.stride) {
-		memcpy(dst.buffer, src.buffer, src.height * src.stride);
+	if (dst.stride == src.stride && src.height > 0) {
+		// do not read past the last row, src may be a ROI.
+		memcpy(
+		    dst.buffer,
+		    src.buffer,
+		    (src.height - 1) * src.stride + src.width
+		);
+		return;
 	}
 
 	if (rt == nullptr) {
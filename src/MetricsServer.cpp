@@ -0,0 +1,236 @@
+#include "MetricsServer.hpp"
+
+#include <array>
+#include <sstream>
+#include <stdexcept>
+
+#include <slog++/slog++.hpp>
+
+#include <fort/utils/Defer.hpp>
+
+#include "utils/Metrics.hpp"
+
+namespace fort {
+namespace artemis {
+
+namespace details {
+// A scrape, from the read of its request to the write of its response.
+struct MetricsExchange {
+	std::shared_ptr<Metrics> Registry;
+	GSocketConnection       *Connection;
+	std::array<char, 4096>   Buffer;
+	std::string              Reply;
+
+	~MetricsExchange() {
+		g_io_stream_close(G_IO_STREAM(Connection), nullptr, nullptr);
+		g_object_unref(Connection);
+	}
+};
+
+std::string HTTPResponse(
+    const std::string &status,
+    const std::string &contentType,
+    const std::string &body
+) {
+	std::ostringstream oss;
+	oss << "HTTP/1.1 " << status << "\r\n"
+	    << "Content-Type: " << contentType << "\r\n"
+	    << "Content-Length: " << body.size() << "\r\n"
+	    << "Connection: close\r\n"
+	    << "\r\n"
+	    << body;
+	return oss.str();
+}
+} // namespace details
+
+MetricsServer::MetricsServer(
+    GMainContext                   *context,
+    const std::shared_ptr<Metrics> &metrics,
+    const std::string              &address,
+    uint16_t                        port
+)
+    : d_metrics{metrics}
+    , d_service{nullptr}
+    , d_port{0}
+    , d_logger{slog::With(slog::String("task", "metrics"))} {
+	if (context == nullptr) {
+		context = g_main_context_default();
+	}
+	// the service accepts connections from the thread default context.
+	g_main_context_push_thread_default(context);
+	Defer {
+		g_main_context_pop_thread_default(context);
+	};
+
+	auto inetAddress = g_inet_address_new_from_string(address.c_str());
+	if (inetAddress == nullptr) {
+		throw std::runtime_error("invalid metrics address '" + address + "'");
+	}
+	auto socketAddress = g_inet_socket_address_new(inetAddress, port);
+	g_object_unref(inetAddress);
+
+	d_service = g_socket_service_new();
+
+	GError         *error     = nullptr;
+	GSocketAddress *effective = nullptr;
+	const bool      ok        = g_socket_listener_add_address(
+	    G_SOCKET_LISTENER(d_service),
+	    socketAddress,
+	    G_SOCKET_TYPE_STREAM,
+	    G_SOCKET_PROTOCOL_TCP,
+	    nullptr,
+	    &effective,
+	    &error
+	);
+	g_object_unref(socketAddress);
+	if (ok == false) {
+		std::string reason = error == nullptr ? "unknown" : error->message;
+		g_clear_error(&error);
+		g_clear_object(&d_service);
+		throw std::runtime_error(
+		    "could not listen on " + address + ":" + std::to_string(port) +
+		    ": " + reason
+		);
+	}
+	d_port = g_inet_socket_address_get_port(G_INET_SOCKET_ADDRESS(effective));
+	g_object_unref(effective);
+
+	g_signal_connect(
+	    d_service,
+	    "incoming",
+	    G_CALLBACK(MetricsServer::onIncoming),
+	    this
+	);
+	g_socket_service_start(d_service);
+
+	d_logger.Info(
+	    "serving metrics",
+	    slog::String("address", address),
+	    slog::Int("port", d_port)
+	);
+}
+
+MetricsServer::~MetricsServer() {
+	g_socket_service_stop(d_service);
+	g_socket_listener_close(G_SOCKET_LISTENER(d_service));
+	g_clear_object(&d_service);
+}
+
+uint16_t MetricsServer::Port() const {
+	return d_port;
+}
+
+std::string
+MetricsServer::Response(const std::string &request, Metrics &metrics) {
+	std::istringstream iss{request};
+	std::string        method;
+	iss >> method;
+	if (method != "GET") {
+		return details::HTTPResponse(
+		    "405 Method Not Allowed",
+		    "text/plain",
+		    "only GET is supported\n"
+		);
+	}
+	try {
+		return details::HTTPResponse(
+		    "200 OK",
+		    "text/plain; version=0.0.4; charset=utf-8",
+		    metrics.Format()
+		);
+	} catch (const std::exception &e) {
+		return details::HTTPResponse(
+		    "500 Internal Server Error",
+		    "text/plain",
+		    std::string(e.what()) + "\n"
+		);
+	}
+}
+
+gboolean MetricsServer::onIncoming(
+    GSocketService    *service,
+    GSocketConnection *connection,
+    GObject           *sourceObject,
+    gpointer           userdata
+) {
+	auto self     = reinterpret_cast<MetricsServer *>(userdata);
+	auto exchange = new details::MetricsExchange{
+	    .Registry   = self->d_metrics,
+	    .Connection = G_SOCKET_CONNECTION(g_object_ref(connection)),
+	};
+
+	// scrapers send their request at once, and a single read is enough to
+	// get its method.
+	g_input_stream_read_async(
+	    g_io_stream_get_input_stream(G_IO_STREAM(connection)),
+	    exchange->Buffer.data(),
+	    exchange->Buffer.size(),
+	    G_PRIORITY_DEFAULT,
+	    nullptr,
+	    [](GObject *source, GAsyncResult *result, gpointer userdata) -> void {
+		    auto exchange = reinterpret_cast<details::MetricsExchange *>(userdata);
+		    GError *error = nullptr;
+		    gssize  read  = g_input_stream_read_finish(
+		        G_INPUT_STREAM(source),
+		        result,
+		        &error
+		    );
+		    if (read <= 0) {
+			    slog::Warn(
+			        "could not read metrics request",
+			        slog::String(
+			            "error",
+			            error == nullptr ? "closed" : error->message
+			        )
+			    );
+			    g_clear_error(&error);
+			    delete exchange;
+			    return;
+		    }
+
+		    exchange->Reply = MetricsServer::Response(
+		        std::string(exchange->Buffer.data(), read),
+		        *exchange->Registry
+		    );
+		    auto stream =
+		        g_io_stream_get_output_stream(G_IO_STREAM(exchange->Connection));
+		    g_output_stream_write_all_async(
+		        stream,
+		        exchange->Reply.data(),
+		        exchange->Reply.size(),
+		        G_PRIORITY_DEFAULT,
+		        nullptr,
+		        [](GObject *source, GAsyncResult *result, gpointer userdata) {
+			        auto exchange =
+			            reinterpret_cast<details::MetricsExchange *>(userdata);
+			        Defer {
+				        delete exchange;
+			        };
+			        GError *error = nullptr;
+			        if (g_output_stream_write_all_finish(
+			                G_OUTPUT_STREAM(source),
+			                result,
+			                nullptr,
+			                &error
+			            ) == false) {
+				        slog::Warn(
+				            "could not write metrics",
+				            slog::String(
+				                "error",
+				                error == nullptr ? "unknown" : error->message
+				            )
+				        );
+				        g_clear_error(&error);
+			        }
+		        },
+		        exchange
+		    );
+	    },
+	    exchange
+	);
+
+	return TRUE;
+}
+
+} // namespace artemis
+} // namespace fort
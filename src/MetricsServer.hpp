@@ -0,0 +1,55 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <slog++/Logger.hpp>
+
+#include <gio/gio.h>
+#include <glib.h>
+
+namespace fort {
+namespace artemis {
+
+class Metrics;
+
+// Serves metrics over HTTP in the Prometheus text format, on any path. It
+// runs from a GMainContext, so scrapes never block the processing threads.
+class MetricsServer {
+public:
+	// Listens on address:port, or on an ephemeral port if port is 0. Throws
+	// std::runtime_error if it cannot listen.
+	MetricsServer(
+	    GMainContext                   *context,
+	    const std::shared_ptr<Metrics> &metrics,
+	    const std::string              &address,
+	    uint16_t                        port
+	);
+	~MetricsServer();
+
+	MetricsServer(const MetricsServer &other)            = delete;
+	MetricsServer(MetricsServer &&other)                 = delete;
+	MetricsServer &operator=(const MetricsServer &other) = delete;
+	MetricsServer &operator=(MetricsServer &&other)      = delete;
+
+	uint16_t Port() const;
+
+	// Returns the HTTP response to a request for the metrics.
+	static std::string Response(const std::string &request, Metrics &metrics);
+
+private:
+	static gboolean onIncoming(
+	    GSocketService    *service,
+	    GSocketConnection *connection,
+	    GObject           *sourceObject,
+	    gpointer           userdata
+	);
+
+	std::shared_ptr<Metrics> d_metrics;
+	GSocketService          *d_service;
+	uint16_t                 d_port;
+	slog::Logger<1>          d_logger;
+};
+
+} // namespace artemis
+} // namespace fort
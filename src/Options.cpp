@@ -1,9 +1,12 @@
 #include "Options.hpp"
 
+#include <algorithm>
 #include <cstdint>
+#include <cstdlib>
 #include <fort/tags/fort-tags.hpp>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 
 #include <fort/options/Options.hpp>
 #include <fort/time/Time.hpp>
@@ -113,6 +116,27 @@ fort::tags::Family ApriltagOptions::Family() const {
 	return ParseTagFamily(family);
 }
 
+fort::tags::Family SyntheticOptions::Family() const {
+	return ParseTagFamily(family);
+}
+
+std::filesystem::path ApriltagOptions::DecodeCacheDir() const {
+	if (NoDecodeCache == true) {
+		return {};
+	}
+	if (decodeCacheDir.empty() == false) {
+		return decodeCacheDir;
+	}
+	if (const char *xdg = std::getenv("XDG_CACHE_HOME");
+	    xdg != nullptr && *xdg != 0) {
+		return std::filesystem::path{xdg} / "artemis";
+	}
+	if (const char *home = std::getenv("HOME"); home != nullptr && *home != 0) {
+		return std::filesystem::path{home} / ".cache" / "artemis";
+	}
+	return {};
+}
+
 std::set<uint64_t> ProcessOptions::FrameIDs() const {
 	auto IDs = ParseCommaSeparatedList(frameIDs);
 	return {IDs.begin(), IDs.end()};
@@ -132,6 +156,9 @@ void Options::Validate() {
 	if (Process.FrameStride == 0) {
 		Process.FrameStride = 1;
 	}
+	if (Process.ParallelFrames == 0) {
+		Process.ParallelFrames = 1;
+	}
 
 	if (Process.frameIDs.empty()) {
 		for (size_t i = 0; i < Process.FrameStride; ++i) {
@@ -168,6 +195,41 @@ void Options::Validate() {
 #endif
 }
 
+void BatchOptions::Validate() {
+	if (Input.empty()) {
+		throw std::invalid_argument("an input directory is required");
+	}
+	if (Output.empty()) {
+		throw std::invalid_argument("an output directory is required");
+	}
+	if (Apriltag.Family() == tags::Family::Undefined) {
+		throw std::invalid_argument("a tag family is required");
+	}
+	if (ParallelFrames == 0) {
+		ParallelFrames = 1;
+	}
+}
+
+void BenchDetectOptions::Validate() {
+	if (Input.empty() && Synthetic.Tags == 0) {
+		throw std::invalid_argument(
+		    "an input directory or synthetic tags are required"
+		);
+	}
+	if (Apriltag.Family() == tags::Family::Undefined) {
+		throw std::invalid_argument("a tag family is required");
+	}
+	if (Frames == 0) {
+		throw std::invalid_argument("at least one frame must be measured");
+	}
+	if (Preload == 0) {
+		Preload = 1;
+	}
+	if (Threads == 0) {
+		Threads = std::max(std::thread::hardware_concurrency(), 1U);
+	}
+}
+
 } // namespace artemis
 } // namespace fort
 
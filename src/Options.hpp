@@ -2,6 +2,7 @@
 
 #include "Rect.hpp"
 #include <cstdint>
+#include <filesystem>
 #include <istream>
 #include <set>
 
@@ -37,6 +38,34 @@ struct LetoOptions : public options::Group {
 	        .SetDefault(3002);
 };
 
+struct MetricsOptions : public options::Group {
+	std::string &Address =
+	    AddOption<std::string>("address", "Address to serve metrics on")
+	        .SetDefault("127.0.0.1");
+	uint16_t &Port =
+	    AddOption<uint16_t>(
+	        "port",
+	        "Port to serve Prometheus metrics on over HTTP, disabled if 0"
+	    )
+	        .SetDefault(0);
+};
+
+struct ProfileOptions : public options::Group {
+	std::string &File =
+	    AddOption<std::string>(
+	        "file",
+	        "Samples the stacks of all threads into this file, to fold them "
+	        "with artemis-tracer. Disabled if empty"
+	    )
+	        .SetDefault("");
+	size_t &Frequency =
+	    AddOption<size_t>("frequency", "Samples per second of CPU time")
+	        .SetDefault(99);
+	size_t &Samples =
+	    AddOption<size_t>("samples", "Number of most recent samples kept")
+	        .SetDefault(65536);
+};
+
 struct StreamOptions : public options::Group {
 	size_t &Height =
 	    AddOption<size_t>("height", "Video stream height").SetDefault(1080);
@@ -148,6 +177,100 @@ public:
 
 	bool &QuadDeglitch =
 	    AddOption<bool>("quad-deglitch", "Deglitch for noisy images");
+
+	size_t &TrackingSweepPeriod =
+	    AddOption<size_t>(
+	        "tracking-sweep-period",
+	        "If larger than 1, detects tags only around the tags of previous "
+	        "frames, and on the full frame every given number of frames"
+	    )
+	        .SetDefault(0);
+
+	int &TrackingWindow =
+	    AddOption<int>(
+	        "tracking-window",
+	        "Size in pixel of the detection window around tracked tags"
+	    )
+	        .SetDefault(300);
+
+	bool &VerifyTrackedTags = AddOption<bool>(
+	    "verify-tracked-tags",
+	    "When tracking, first confirms known tags at their predicted "
+	    "position, and only searches for the ones that failed"
+	);
+
+	bool &AdaptivePartitions = AddOption<bool>(
+	    "adaptive-partitions",
+	    "Moves the boundaries of full frame partitions to balance the measured "
+	    "detection time among threads"
+	);
+
+	size_t &TilesPerWorker =
+	    AddOption<size_t>(
+	        "tiles-per-worker",
+	        "Splits the frame in this many tiles per detection thread. Tiles "
+	        "are pulled by idle threads, which balances uneven tag density "
+	        "at the cost of more redundant margin processing"
+	    )
+	        .SetDefault(1);
+
+	int &StitchHalfWidth =
+	    AddOption<int>(
+	        "stitch-half-width",
+	        "If positive, partitions do not overlap. Tags cut by a partition "
+	        "border are detected in strips of twice this width centered on "
+	        "the borders. Must be larger than the tag diagonal in pixels"
+	    )
+	        .SetDefault(0);
+
+	bool &PooledDecode = AddOption<bool>(
+	    "pooled-decode",
+	    "Searches quads in each partition, then pools them so any idle thread "
+	    "decodes them, which balances partitions with many quads"
+	);
+
+	std::string &Mask =
+	    AddOption<std::string>(
+	        "mask",
+	        "Regions where tags may appear, the rest of the frame is never "
+	        "processed. Either a PNG file of the frame size whose non-zero "
+	        "pixels are processed, or ';' separated polygons of space "
+	        "separated 'x,y' vertices"
+	    )
+	        .SetDefault("");
+
+	int &MotionThreshold =
+	    AddOption<int>(
+	        "motion-threshold",
+	        "If positive, full frame tiles whose 8x8 block means changed by "
+	        "less than this value since their last detection reuse their "
+	        "previous detections"
+	    )
+	        .SetDefault(0);
+
+	size_t &MotionRefreshPeriod =
+	    AddOption<size_t>(
+	        "motion-refresh-period",
+	        "When reusing static tiles, detects every tile at least once per "
+	        "this number of frames"
+	    )
+	        .SetDefault(8);
+
+	std::string &decodeCacheDir =
+	    AddOption<std::string>(
+	        "decode-cache-dir",
+	        "Directory where quick decode tables are cached. Defaults to "
+	        "$XDG_CACHE_HOME/artemis"
+	    )
+	        .SetDefault("");
+
+	bool &NoDecodeCache = AddOption<bool>(
+	    "no-decode-cache", "Always builds quick decode tables at startup"
+	);
+
+	// Returns an empty path if caching is disabled or no cache directory
+	// could be found.
+	std::filesystem::path DecodeCacheDir() const;
 };
 
 struct CameraOptions : public options::Group {
@@ -180,10 +303,92 @@ struct ProcessOptions : public options::Group {
 
 	std::set<uint64_t> FrameIDs() const;
 
+	size_t &ParallelFrames =
+	    AddOption<size_t>(
+	        "parallel-frames",
+	        "Number of frames detected in parallel, each by its own detector "
+	        "with a share of the threads. Raises throughput at the cost of "
+	        "latency. Disables tracking if larger than 1"
+	    )
+	        .SetDefault(1);
+
+	bool &NoDegradation = AddOption<bool>(
+	    "no-degradation",
+	    "When processing is slower than the camera, drops frames immediately "
+	    "instead of first reducing the detection cost"
+	);
+
 	std::string &UUID = AddOption<std::string>(
 	                        "uuid", "The UUID to mark data sent over network"
 	)
 	                        .SetDefault("");
+
+	std::string &TraceFile =
+	    AddOption<std::string>(
+	        "trace-file",
+	        "Records the processing tasks of each worker and writes them to "
+	        "this file, in Chrome trace format. Disabled if empty"
+	    )
+	        .SetDefault("");
+
+	size_t &TraceSkip =
+	    AddOption<size_t>(
+	        "trace-skip", "Number of frames to let through before tracing"
+	    )
+	        .SetDefault(100);
+
+	size_t &TraceFrames =
+	    AddOption<size_t>("trace-frames", "Number of frames to trace")
+	        .SetDefault(20);
+};
+
+struct SyntheticOptions : public options::Group {
+protected:
+	std::string &family =
+	    AddOption<std::string>("family", "Family of the synthetic tags")
+	        .SetDefault("36h11");
+
+public:
+	tags::Family Family() const;
+
+	size_t &Tags = AddOption<size_t>(
+	                   "tags",
+	                   "Number of synthetic tags to render instead of using "
+	                   "a camera. 0 disables synthetic frames"
+	)
+	                   .SetDefault(0);
+
+	size_t &Width =
+	    AddOption<size_t>("width", "Width of synthetic frames").SetDefault(2048);
+	size_t &Height = AddOption<size_t>("height", "Height of synthetic frames")
+	                     .SetDefault(1536);
+
+	size_t &TagSize =
+	    AddOption<size_t>("tag-size", "Size of synthetic tags in pixels")
+	        .SetDefault(48);
+
+	double &Speed =
+	    AddOption<double>("speed", "Speed of synthetic tags in pixels per frame")
+	        .SetDefault(2.0);
+
+	size_t &Blur =
+	    AddOption<size_t>("blur", "Radius of the box blur applied on tags")
+	        .SetDefault(1);
+
+	size_t &Noise =
+	    AddOption<size_t>("noise", "Amplitude of the uniform pixel noise")
+	        .SetDefault(4);
+
+	size_t &Seed =
+	    AddOption<size_t>("seed", "Seed of the synthetic scene").SetDefault(0);
+
+	std::string &TruthFile =
+	    AddOption<std::string>(
+	        "truth-file",
+	        "File to write the ground truth in, as 'frameID tagID x y theta' "
+	        "lines"
+	    )
+	        .SetDefault("");
 };
 
 struct Options : public options::Group {
@@ -200,6 +405,20 @@ public:
 	    AddOption<bool>("version,V", "Print the version and exit");
 	bool &PrintResolution =
 	    AddOption<bool>("fetch-resolution", "Prints the camera resolution");
+	bool &StubUnpaced = AddOption<bool>(
+	    "stub-unpaced",
+	    "Delivers stub or synthetic frames as fast as possible instead of at "
+	    "the camera FPS, to measure the maximal sustainable frame rate"
+	);
+	size_t &StubPrefetch =
+	    AddOption<size_t>(
+	        "stub-prefetch",
+	        "Decodes stub images while running, at most this many ahead, "
+	        "instead of loading them all in memory at start. 0 loads all "
+	        "images"
+	    )
+	        .SetDefault(0);
+
 	std::string &LogDir =
 	    AddOption<std::string>("log-output-dir", "Directory to puts logs in")
 	        .SetDefault("");
@@ -234,6 +453,11 @@ public:
 	LetoOptions &Leto = AddSubgroup<LetoOptions>(
 	    "leto", "Options regarding communication with leto"
 	);
+	MetricsOptions &Metrics =
+	    AddSubgroup<MetricsOptions>("metrics", "Options regarding metrics");
+	ProfileOptions &Profile = AddSubgroup<ProfileOptions>(
+	    "profile", "Options regarding the sampling profiler"
+	);
 	VideoOutputOptions &VideoOutput = AddSubgroup<VideoOutputOptions>(
 	    "video-output", "Options regarding video output"
 	);
@@ -245,6 +469,105 @@ public:
 	ProcessOptions &Process = AddSubgroup<ProcessOptions>(
 	    "process", "options regarding process of frames"
 	);
+	SyntheticOptions &Synthetic = AddSubgroup<SyntheticOptions>(
+	    "synthetic", "options regarding synthetic frames replacing the camera"
+	);
+
+	void Validate();
+};
+
+// Options of artemis-batch, which reprocesses archived frames offline.
+struct BatchOptions : public options::Group {
+	std::string &Input =
+	    AddOption<std::string>(
+	        "input",
+	        "Directory to reprocess, either PNG files or a video output "
+	        "directory with its frame-matching files"
+	    )
+	        .SetDefault("");
+
+	std::string &Output =
+	    AddOption<std::string>(
+	        "output", "Directory to write the tracking.%04d.hermes files in"
+	    )
+	        .SetDefault("");
+
+	double &FPS = AddOption<double>(
+	                  "fps",
+	                  "Nominal camera FPS, used to compute the readout "
+	                  "timestamps as archives have none"
+	)
+	                  .SetDefault(8.0);
+
+	size_t &ParallelFrames =
+	    AddOption<size_t>(
+	        "parallel-frames",
+	        "Number of frames detected in parallel, each by its own detector "
+	        "with a share of the threads"
+	    )
+	        .SetDefault(2);
+
+	size_t &SegmentSize =
+	    AddOption<size_t>("segment-size", "Number of readouts per output file")
+	        .SetDefault(10000);
+
+	std::string &UUID =
+	    AddOption<std::string>("uuid", "The UUID to mark readouts with")
+	        .SetDefault("");
+
+	ApriltagOptions &Apriltag =
+	    AddSubgroup<ApriltagOptions>("at", "option regarding tag detection");
+
+	void Validate();
+};
+
+struct BenchDetectOptions : public options::Group {
+	std::string &Input =
+	    AddOption<std::string>(
+	        "input",
+	        "Directory of frames to detect in, either PNG files or a video "
+	        "output directory. Synthetic frames are used if empty"
+	    )
+	        .SetDefault("");
+
+	size_t &Frames =
+	    AddOption<size_t>("frames", "Number of measured detections")
+	        .SetDefault(200);
+
+	size_t &Warmup =
+	    AddOption<size_t>(
+	        "warmup", "Number of detections run before measuring"
+	    )
+	        .SetDefault(10);
+
+	size_t &Preload =
+	    AddOption<size_t>(
+	        "preload",
+	        "Number of distinct frames kept in memory and cycled through"
+	    )
+	        .SetDefault(16);
+
+	size_t &Threads =
+	    AddOption<size_t>(
+	        "threads",
+	        "Maximal number of partitions detected concurrently. 0 uses all "
+	        "cores"
+	    )
+	        .SetDefault(0);
+
+	bool &Sweep = AddOption<bool>(
+	                  "sweep",
+	                  "Measures every concurrency from 1 to threads instead "
+	                  "of threads only"
+	)
+	                  .SetDefault(false);
+
+	ApriltagOptions &Apriltag =
+	    AddSubgroup<ApriltagOptions>("at", "option regarding tag detection");
+
+	SyntheticOptions &Synthetic = AddSubgroup<SyntheticOptions>(
+	    "synthetic", "options regarding synthetic frames"
+	);
 
 	void Validate();
 };
@@ -16,6 +16,10 @@ TEST_F(OptionsUTest, DefaultValues) {
 	EXPECT_EQ(options.PrintResolution, false);
 	EXPECT_EQ(options.LogDir, "");
 	EXPECT_TRUE(options.StubImagePaths().empty());
+	EXPECT_FALSE(options.StubUnpaced);
+	EXPECT_EQ(options.Synthetic.Tags, 0);
+	EXPECT_EQ(options.Synthetic.Family(), fort::tags::Family::Tag36h11);
+	EXPECT_EQ(options.StubPrefetch, 0);
 	EXPECT_EQ(options.TestMode, false);
 	EXPECT_EQ(options.LegacyMode, false);
 
@@ -24,6 +28,13 @@ TEST_F(OptionsUTest, DefaultValues) {
 	EXPECT_EQ(options.Leto.Host, "");
 	EXPECT_EQ(options.Leto.Port, 3002);
 
+	EXPECT_EQ(options.Metrics.Address, "127.0.0.1");
+	EXPECT_EQ(options.Metrics.Port, 0);
+
+	EXPECT_EQ(options.Profile.File, "");
+	EXPECT_EQ(options.Profile.Frequency, 99);
+	EXPECT_EQ(options.Profile.Samples, 65536);
+
 	EXPECT_EQ(options.VideoOutput.Height, 1080);
 	EXPECT_EQ(options.VideoOutput.Height, 1080);
 
@@ -45,6 +56,18 @@ TEST_F(OptionsUTest, DefaultValues) {
 	EXPECT_FLOAT_EQ(options.Apriltag.QuadMaxLineMSE, 10.0);
 	EXPECT_EQ(options.Apriltag.QuadMinBWDiff, 40);
 	EXPECT_EQ(options.Apriltag.QuadDeglitch, false);
+	EXPECT_EQ(options.Apriltag.TrackingSweepPeriod, 0);
+	EXPECT_EQ(options.Apriltag.TrackingWindow, 300);
+	EXPECT_FALSE(options.Apriltag.VerifyTrackedTags);
+	EXPECT_FALSE(options.Apriltag.AdaptivePartitions);
+	EXPECT_EQ(options.Apriltag.TilesPerWorker, 1);
+	EXPECT_EQ(options.Apriltag.StitchHalfWidth, 0);
+	EXPECT_FALSE(options.Apriltag.PooledDecode);
+	EXPECT_TRUE(options.Apriltag.Mask.empty());
+	EXPECT_EQ(options.Apriltag.MotionThreshold, 0);
+	EXPECT_EQ(options.Apriltag.MotionRefreshPeriod, 8);
+	EXPECT_TRUE(options.Apriltag.decodeCacheDir.empty());
+	EXPECT_FALSE(options.Apriltag.NoDecodeCache);
 
 	EXPECT_FLOAT_EQ(options.Camera.FPS, 8.0);
 	EXPECT_EQ(options.Camera.StrobeDuration, 1500 * Duration::Microsecond);
@@ -52,10 +75,15 @@ TEST_F(OptionsUTest, DefaultValues) {
 
 	EXPECT_EQ(options.Process.FrameStride, 1);
 	EXPECT_TRUE(options.Process.FrameIDs().empty());
+	EXPECT_EQ(options.Process.ParallelFrames, 1);
+	EXPECT_FALSE(options.Process.NoDegradation);
 	EXPECT_EQ(options.CloseUpOutputDir, "");
 	EXPECT_EQ(options.CloseUpROISize, 600);
 	EXPECT_EQ(options.RenewPeriod, 2 * Duration::Hour);
 	EXPECT_EQ(options.Process.UUID, "");
+	EXPECT_EQ(options.Process.TraceFile, "");
+	EXPECT_EQ(options.Process.TraceSkip, 100);
+	EXPECT_EQ(options.Process.TraceFrames, 20);
 }
 
 TEST_F(OptionsUTest, TestParse) {
@@ -81,6 +109,16 @@ TEST_F(OptionsUTest, TestParse) {
 			     EXPECT_EQ(paths[2], "baz");
 		     }
 	     }},
+	    {{"artemis", "--stub-unpaced", "--stub-prefetch", "4"},
+	     [](const Options &options) {
+		     EXPECT_TRUE(options.StubUnpaced);
+		     EXPECT_EQ(options.StubPrefetch, 4);
+	     }},
+	    {{"artemis", "--synthetic.tags", "12", "--synthetic.family", "16h5"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Synthetic.Tags, 12);
+		     EXPECT_EQ(options.Synthetic.Family(), fort::tags::Family::Tag16h5);
+	     }},
 	    {{"artemis", "--test-mode"},
 	     [](const Options &options) { EXPECT_TRUE(options.TestMode); }},
 	    {{"artemis", "--legacy-mode"},
@@ -89,6 +127,23 @@ TEST_F(OptionsUTest, TestParse) {
 	     [](const Options &options) { EXPECT_EQ(options.Leto.Host, "foo"); }},
 	    {{"artemis", "--leto.port", "1234"},
 	     [](const Options &options) { EXPECT_EQ(options.Leto.Port, 1234); }},
+	    {{"artemis", "--metrics.address", "0.0.0.0", "--metrics.port", "9100"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Metrics.Address, "0.0.0.0");
+		     EXPECT_EQ(options.Metrics.Port, 9100);
+	     }},
+	    {{"artemis",
+	      "--profile.file",
+	      "artemis.prof",
+	      "--profile.frequency",
+	      "250",
+	      "--profile.samples",
+	      "1000"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Profile.File, "artemis.prof");
+		     EXPECT_EQ(options.Profile.Frequency, 250);
+		     EXPECT_EQ(options.Profile.Samples, 1000);
+	     }},
 	    {{"artemis", "--process.uuid", "abcdef123456"},
 	     [](const Options &options) {
 		     EXPECT_EQ(options.Process.UUID, "abcdef123456");
@@ -132,6 +187,29 @@ TEST_F(OptionsUTest, TestParse) {
 		     EXPECT_EQ(highlighted.count(0x0ae), 1);
 	     }},
 
+	    {{"artemis", "--process.parallel-frames", "3"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Process.ParallelFrames, 3);
+	     }},
+
+	    {{"artemis", "--process.no-degradation"},
+	     [](const Options &options) {
+		     EXPECT_TRUE(options.Process.NoDegradation);
+	     }},
+
+	    {{"artemis",
+	      "--process.trace-file",
+	      "trace.json",
+	      "--process.trace-skip",
+	      "10",
+	      "--process.trace-frames",
+	      "5"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Process.TraceFile, "trace.json");
+		     EXPECT_EQ(options.Process.TraceSkip, 10);
+		     EXPECT_EQ(options.Process.TraceFrames, 5);
+	     }},
+
 	    {{"artemis", "--process.stride", "33"},
 	     [](const Options &options) {
 		     EXPECT_EQ(options.Process.FrameStride, 33);
@@ -240,6 +318,69 @@ TEST_F(OptionsUTest, TestParse) {
 		     EXPECT_TRUE(options.Apriltag.QuadDeglitch);
 	     }},
 
+	    {{"artemis", "--at.tracking-sweep-period", "8"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Apriltag.TrackingSweepPeriod, 8);
+	     }},
+
+	    {{"artemis", "--at.tracking-window", "250"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Apriltag.TrackingWindow, 250);
+	     }},
+
+	    {{"artemis", "--at.verify-tracked-tags"},
+	     [](const Options &options) {
+		     EXPECT_TRUE(options.Apriltag.VerifyTrackedTags);
+	     }},
+
+	    {{"artemis", "--at.adaptive-partitions"},
+	     [](const Options &options) {
+		     EXPECT_TRUE(options.Apriltag.AdaptivePartitions);
+	     }},
+
+	    {{"artemis", "--at.tiles-per-worker", "4"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Apriltag.TilesPerWorker, 4);
+	     }},
+
+	    {{"artemis", "--at.stitch-half-width", "60"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Apriltag.StitchHalfWidth, 60);
+	     }},
+
+	    {{"artemis", "--at.pooled-decode"},
+	     [](const Options &options) {
+		     EXPECT_TRUE(options.Apriltag.PooledDecode);
+	     }},
+
+	    {{"artemis", "--at.mask", "0,0 10,0 10,10"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Apriltag.Mask, "0,0 10,0 10,10");
+	     }},
+
+	    {{"artemis", "--at.motion-threshold", "6"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Apriltag.MotionThreshold, 6);
+	     }},
+
+	    {{"artemis", "--at.motion-refresh-period", "4"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Apriltag.MotionRefreshPeriod, 4);
+	     }},
+
+	    {{"artemis", "--at.decode-cache-dir", "/tmp/foo"},
+	     [](const Options &options) {
+		     EXPECT_EQ(options.Apriltag.DecodeCacheDir(), "/tmp/foo");
+	     }},
+
+	    {{"artemis",
+	      "--at.decode-cache-dir",
+	      "/tmp/foo",
+	      "--at.no-decode-cache"},
+	     [](const Options &options) {
+		     EXPECT_TRUE(options.Apriltag.DecodeCacheDir().empty());
+	     }},
+
 	    {{"artemis", "--at.family", "36ARTag"},
 	     [](const Options &options) {
 		     EXPECT_EQ(
@@ -13,11 +13,16 @@
 
 #include "ApriltagDetector.hpp"
 #include "Connection.hpp"
+#include "DegradationPolicy.hpp"
+#include "FrameLatency.hpp"
 #include "ImageU8.hpp"
+#include "TagTracker.hpp"
 #include "UserInterfaceTask.hpp"
 #include "VideoOutput.hpp"
 
 #include "utils/Slog.hpp"
+#include "utils/Metrics.hpp"
+#include "utils/TaskflowProfiler.hpp"
 
 namespace fort {
 namespace artemis {
@@ -37,10 +42,10 @@ ProcessFrameTask::ProcessFrameTask(
 )
     : d_config{options}
     , d_maximumThreads{std::thread::hardware_concurrency() > 2 ? std::thread::hardware_concurrency() - 2 : 1}
+    , d_latency{std::make_shared<FrameLatency>(Duration::Minute)}
     , d_workingResolution{workingResolution({1920, 1080}, inputResolution)}
     , d_executor{d_maximumThreads}
-    , d_logger{slog::With(slog::String("task", "process"))}
-    , d_current{} {
+    , d_logger{slog::With(slog::String("task", "process"))} {
 	d_actualThreads = d_maximumThreads;
 
 	SetUpDetection(inputResolution, options.Apriltag);
@@ -52,6 +57,8 @@ ProcessFrameTask::ProcessFrameTask(
 	);
 	SetUpCataloguing(options);
 	SetUpConnection(options.Leto, context);
+	SetUpDegradation(options);
+	SetUpProfiling(options.Process);
 
 	std::string ids, prefix;
 	for (const auto &id : options.Process.FrameIDs()) {
@@ -68,158 +75,287 @@ ProcessFrameTask::ProcessFrameTask(
 }
 
 void ProcessFrameTask::SetUpTaskflow() {
-	if (d_video != nullptr) {
-		d_taskflow.emplace([this]() { d_video->PushFrame(d_current.Frame); }
-		).name("videoOutput");
+	// each detector is used by the same slots, so their number is a multiple
+	// of the number of detectors.
+	const size_t detectors = std::max(d_detectors.size(), size_t(1));
+	const size_t slots =
+	    detectors * ((ARTEMIS_PROCESS_SLOTS + 2 * detectors - 2) / detectors);
+	d_slots.reserve(slots);
+	for (size_t i = 0; i < slots; ++i) {
+		d_slots.push_back(std::make_unique<Slot>());
+		d_slots.back()->Detector = i % detectors;
+		SetUpHead(*d_slots.back());
+		SetUpTail(*d_slots.back());
 	}
+	d_lastHeads.resize(detectors);
 
-	auto [processIgnoreOrDrop, detectionDone] = d_taskflow.emplace(
-	    [this]() {
-		    bool shouldProcess = ShouldProcess(d_current.Frame->ID());
-		    if (shouldProcess || d_current.Readout == nullptr) {
-			    d_current.Readout = d_messagePool->Get();
-			    PrepareMessage(d_current.Frame, *d_current.Readout);
+#ifndef NDEBUG
+	std::ofstream out("./graph.dot");
+	d_slots.front()->Head.dump(out);
+	d_slots.front()->Tail.dump(out);
+#endif
+}
+
+void ProcessFrameTask::SetUpHead(Slot &slot) {
+	auto &data = slot.Data;
+
+	// the decision is taken by Admit().
+	auto [processIgnoreOrDrop, detectionDone] = slot.Head.emplace(
+	    [&slot]() { return slot.Action; },
+	    [this, &slot, &data]() {
+		    // a counter exported as a metric, it must never decrease.
+		    if (slot.Action != 2) {
+			    ++d_frameProcessed;
 		    }
-		    if (shouldProcess && d_frameQueue.peek() != nullptr) {
-			    return 2; // drop the frame
+		    if (data.DetectStart.has_value()) {
+			    data.Detected = Time::Now();
+			    d_latency->Record(
+			        FrameLatency::Stage::Detect,
+			        data.DetectStart,
+			        data.Detected.value()
+			    );
 		    }
-
-		    return shouldProcess ? 0 : 1;
-	    },
-	    [this]() { ++d_frameProcessed; }
+	    }
 	);
 	processIgnoreOrDrop.name("processIgnoreOrDrop");
 	detectionDone.name("detectionDone");
 
 	auto dropFrame =
-	    d_taskflow
-	        .emplace([this]() {
-		        DropFrame(d_current.Frame);
-		        --d_frameProcessed; // detectionDone will increment it again.
+	    slot.Head
+	        .emplace([this, &data]() {
+		        DropFrame(data);
 		        return 0;
 	        })
 	        .name("dropFrame");
 
 	dropFrame.precede(detectionDone);
 
-	if (d_detector) {
-		auto detect =
-		    d_taskflow.composed_of(d_detector->Taskflow()).name("detect");
-		auto prepare = d_taskflow
-		                   .emplace([this]() {
-			                   d_detector->SetInputOutput(
-			                       d_current.Frame->ToImageU8(),
-			                       d_current.Readout.get()
-			                   );
-		                   })
-		                   .name("prepare");
-		prepare.precede(detect);
-		detect.precede(detectionDone);
-		processIgnoreOrDrop.precede(prepare, detectionDone, dropFrame);
-	} else {
+	if (d_detectors.empty()) {
 		processIgnoreOrDrop.precede(detectionDone, detectionDone, dropFrame);
+		slot.Head.name("processFrameHead");
+		return;
+	}
+
+	auto &detector = *d_detectors[slot.Detector];
+	auto  detect   = slot.Head.composed_of(detector.Taskflow()).name("detect");
+	auto  prepare =
+	    slot.Head
+	        .emplace([this, &data, &detector, i = slot.Detector]() {
+		        data.DetectStart = Time::Now();
+		        d_latency->Record(
+		            FrameLatency::Stage::Wait,
+		            data.Dequeued,
+		            data.DetectStart.value()
+		        );
+		        data.Degradation = ApplyDegradation(i);
+		        const Partition *rois = nullptr;
+		        if (d_tracker && d_tracker->Plan(
+		                             data.Frame->ID(),
+		                             d_trackedROIs,
+		                             Degraded(Degradation::TrackedOnly)
+		                         ) == false) {
+			        rois = &d_trackedROIs;
+		        }
+		        detector.SetInputOutput(
+		            data.Frame->ToImageU8(),
+		            data.Readout.get(),
+		            rois
+		        );
+	        })
+	        .name("prepare");
+	prepare.precede(detect);
+	if (d_tracker) {
+		auto track = slot.Head
+		                 .emplace([this, &data]() {
+			                 d_tracker->Update(*data.Readout);
+		                 })
+		                 .name("track");
+		detect.precede(track);
+		track.precede(detectionDone);
+	} else {
+		detect.precede(detectionDone);
+	}
+	processIgnoreOrDrop.precede(prepare, detectionDone, dropFrame);
+
+	slot.Head.name("processFrameHead");
+}
+
+void ProcessFrameTask::SetUpTail(Slot &slot) {
+	auto &data = slot.Data;
+
+	if (d_video != nullptr) {
+		slot.Tail.emplace([this, &data]() { d_video->PushFrame(data.Frame); })
+		    .name("videoOutput");
 	}
 
 	if (d_connection) {
-		auto upstream = d_taskflow.emplace([this]() {
-			d_connection->PostMessage(
-			    *d_current.Readout,
-			    d_current.Readout->frameid()
-			);
-		});
-		upstream.succeed(detectionDone);
+		slot.Tail
+		    .emplace([this, &data]() {
+			    d_latency->Record(
+			        FrameLatency::Stage::Output,
+			        data.Detected,
+			        Time::Now()
+			    );
+			    d_connection->PostMessage(
+			        *data.Readout,
+			        data.Readout->frameid(),
+			        data.Frame->Time()
+			    );
+		    })
+		    .name("upstream");
 	}
 
 	if (d_config.CloseUpDir.empty() == false) {
 		std::filesystem::create_directories(d_config.CloseUpDir);
 
-		auto exportFullFrame =
-		    d_taskflow
-		        .emplace([this]() {
-			        if (d_current.Frame->Time().Before(d_nextFrameExport)) {
-				        return;
-			        }
-
-			        // reduce concurrency if needed
-			        if (d_detector) {
-				        d_detector->SetMaxConcurrency(d_maximumThreads - 1);
-			        }
-			        // forces to hold a reference to frame to avoid the race
-			        // condition where possibly the async is not scheduled
-			        // before returning from this task which would potentially
-			        // invalidate d_current.Frame.
-			        d_executor.silent_async([this, frame = d_current.Frame]() {
-				        ExportFullFrame(frame);
-				        // done, we can give more room to other tasks.
-				        if (d_detector) {
-					        d_detector->SetMaxConcurrency(d_maximumThreads);
-				        }
-			        });
-		        })
-		        .name("exportFull");
-		auto catalogAnt =
-		    d_taskflow
-		        .emplace([this](tf::Runtime &rt) {
-			        CatalogTag(d_current.Frame, d_current.Readout, rt);
-		        })
-		        .name("catalogIndividuals");
-		detectionDone.precede(catalogAnt, exportFullFrame);
+		slot.Tail
+		    .emplace([this, &data]() {
+			    if (data.Frame->Time().Before(d_nextFrameExport)) {
+				    return;
+			    }
+
+			    // reduce concurrency if needed
+			    for (auto &d : d_detectors) {
+				    d->SetMaxConcurrency(d_detectorThreads - 1);
+			    }
+			    // forces to hold a reference to frame to avoid the race
+			    // condition where possibly the async is not scheduled
+			    // before returning from this task which would potentially
+			    // invalidate data.Frame.
+			    d_executor.silent_async([this, frame = data.Frame]() {
+				    ExportFullFrame(frame);
+				    // done, we can give more room to other tasks.
+				    for (auto &d : d_detectors) {
+					    d->SetMaxConcurrency(d_detectorThreads);
+				    }
+			    });
+		    })
+		    .name("exportFull");
+		slot.Tail
+		    .emplace([this, &data](tf::Runtime &rt) {
+			    CatalogTag(data.Frame, data.Readout, rt);
+		    })
+		    .name("catalogIndividuals");
 	}
 
 	if (d_userInterface) {
-		auto fullResize = d_taskflow
-		                      .emplace([this]() {
-			                      d_current.Full = d_imagePool->Get();
+		auto fullResize = slot.Tail
+		                      .emplace([this, &data]() {
+			                      data.Full = d_imagePool->Get();
 
 			                      ImageU8::Resize(
-			                          *d_current.Full,
-			                          d_current.Frame->ToImageU8(),
+			                          *data.Full,
+			                          data.Frame->ToImageU8(),
 			                          ImageU8::ScaleMode::None
 			                      );
 		                      })
 		                      .name("fullScaleDown");
 		auto zoomResize =
-		    d_taskflow
-		        .emplace([this]() {
+		    slot.Tail
+		        .emplace([this, &data]() {
 			        d_wantedROI = d_userInterface->UpdateROI(d_wantedROI);
 
-			        if (d_wantedROI.Size() == d_current.Frame->Size()) {
-				        d_current.Zoomed = nullptr;
+			        if (d_wantedROI.Size() == data.Frame->Size()) {
+				        data.Zoomed = nullptr;
 				        return;
 			        }
 
 			        slog::DDebug(
 			            "zooming",
-			            slog::Int("FrameID", d_current.Frame->ID()),
+			            slog::Int("FrameID", data.Frame->ID()),
 			            slogRect("ROI", d_wantedROI)
 			        );
 
-			        d_current.Zoomed = d_imagePool->Get();
+			        data.Zoomed = d_imagePool->Get();
 
 			        ImageU8::Resize(
-			            *d_current.Zoomed,
-			            d_current.Frame->ToImageU8().GetROI(d_wantedROI),
+			            *data.Zoomed,
+			            data.Frame->ToImageU8().GetROI(d_wantedROI),
 			            ImageU8::ScaleMode::None
 			        );
 		        })
 		        .name("ROIScaleDown");
 
-		auto display = d_taskflow
-		                   .emplace([this]() {
-			                   DisplayFrame(d_current.Frame, d_current.Readout);
-		                   })
+		auto display = slot.Tail
+		                   .emplace([this, &data]() { DisplayFrame(data); })
 		                   .name("display");
-		// will only display if the resize are done, or either detection or
-		// noDetection or dropped frame is done.
-		display.succeed(fullResize, zoomResize, detectionDone);
+		// the tail only starts once the detection is done.
+		display.succeed(fullResize, zoomResize);
 	}
 
-	d_taskflow.name("processFrame");
+	slot.Tail.name("processFrameTail");
+}
 
-#ifndef NDEBUG
-	std::ofstream out("./graph.dot");
-	d_taskflow.dump(out);
-#endif
+void ProcessFrameTask::Launch(Slot &slot) {
+	// frames are admitted in order, once their detector is free. Heads using
+	// the same detector run one after the other. Tails are chained, so
+	// outputs stay in order, but the tail of a frame runs concurrently with
+	// the following heads.
+	auto &lastHead = d_lastHeads[slot.Detector];
+
+	std::vector<tf::AsyncTask> dependencies;
+	for (const auto &t : {d_lastAdmit, lastHead}) {
+		if (t.empty() == false) {
+			dependencies.push_back(t);
+		}
+	}
+	auto [admit, admitted] = d_executor.dependent_async(
+	    [this, &slot]() { Admit(slot); },
+	    dependencies.begin(),
+	    dependencies.end()
+	);
+
+	dependencies = {admit};
+	auto [head, headDone] = d_executor.dependent_async(
+	    [this, &slot]() {
+		    const auto start = Time::Now();
+		    d_executor.corun(slot.Head);
+		    slot.Processing = Time::Now().Sub(start);
+	    },
+	    dependencies.begin(),
+	    dependencies.end()
+	);
+
+	dependencies = {head};
+	if (d_lastTail.empty() == false) {
+		dependencies.push_back(d_lastTail);
+	}
+	auto [tail, tailDone] = d_executor.dependent_async(
+	    [this, &slot]() {
+		    // dropped frames take no time, and would lower the level that
+		    // drops them.
+		    if (slot.Action != 2) {
+			    UpdateDegradation(slot.Data, slot.Processing);
+		    }
+		    d_executor.corun(slot.Tail);
+		    // release all memory from here.
+		    slot.Data = ProcessedData{};
+	    },
+	    dependencies.begin(),
+	    dependencies.end()
+	);
+
+	d_lastAdmit = admit;
+	lastHead    = head;
+	d_lastTail  = tail;
+	slot.Done   = std::move(tailDone);
+}
+
+void ProcessFrameTask::Admit(Slot &slot) {
+	--d_waitingFrames;
+	auto &data          = slot.Data;
+	bool  shouldProcess = ShouldProcess(data.Frame->ID());
+	if (shouldProcess || d_lastReadout == nullptr) {
+		d_lastReadout = d_messagePool->Get();
+		PrepareMessage(data.Frame, *d_lastReadout);
+	}
+	// frames not processed are displayed with the last readout.
+	data.Readout = d_lastReadout;
+	if (shouldProcess && ShouldDrop()) {
+		slot.Action = 2; // drop the frame
+		return;
+	}
+	slot.Action = shouldProcess ? 0 : 1;
 }
 
 void ProcessFrameTask::ExportFullFrame(Frame::Ptr frame) {
@@ -261,10 +397,44 @@ void ProcessFrameTask::SetUpDetection(
 	if (options.Family() == tags::Family::Undefined) {
 		return;
 	}
-	d_detector = std::make_unique<ApriltagDetector>(
-	    d_maximumThreads,
+	// each detector processes its own frames with its share of the threads.
+	const size_t parallelFrames = std::max(d_config.ParallelFrames, size_t(1));
+	d_detectorThreads = std::max(d_maximumThreads / parallelFrames, size_t(1));
+	for (size_t i = 0; i < parallelFrames; ++i) {
+		d_detectors.push_back(std::make_unique<ApriltagDetector>(
+		    d_detectorThreads,
+		    inputResolution,
+		    options
+		));
+	}
+	d_appliedLevels.assign(parallelFrames, 0);
+	if (parallelFrames > 1) {
+		d_logger.Info(
+		    "detecting frames in parallel",
+		    slog::Int("frames", parallelFrames),
+		    slog::Int("threads_per_frame", d_detectorThreads)
+		);
+	}
+
+	if (options.TrackingSweepPeriod <= 1) {
+		return;
+	}
+	if (parallelFrames > 1) {
+		d_logger.Warn(
+		    "tracking needs the previous frame, it is disabled with parallel "
+		    "frames"
+		);
+		return;
+	}
+	d_tracker = std::make_unique<TagTracker>(
 	    inputResolution,
-	    options
+	    options.TrackingSweepPeriod,
+	    options.TrackingWindow
+	);
+	d_logger.Info(
+	    "tracking guided detection",
+	    slog::Int("sweep_period", options.TrackingSweepPeriod),
+	    slog::Int("window", options.TrackingWindow)
 	);
 }
 
@@ -289,6 +459,52 @@ void ProcessFrameTask::SetUpConnection(
 	    options.Port,
 	    5 * Duration::Second
 	);
+	d_connection->SetLatency(d_latency);
+}
+
+void ProcessFrameTask::SetUpDegradation(const Options &options) {
+	if (options.Process.NoDegradation || options.Camera.FPS <= 0.0) {
+		return;
+	}
+	if (d_detectors.empty() == false) {
+		if (options.Apriltag.RefineEdges) {
+			d_degradations.push_back(Degradation::SkipRefineEdges);
+		}
+		d_degradations.push_back(Degradation::RaiseDecimation);
+	}
+	if (d_tracker) {
+		d_degradations.push_back(Degradation::TrackedOnly);
+	}
+	d_degradations.push_back(Degradation::DropFrames);
+
+	d_degradation =
+	    std::make_unique<DegradationPolicy>(DegradationPolicy::Config{
+	        // frames in parallel each have more time.
+	        .Period = double(d_detectors.size() > 1 ? d_detectors.size() : 1) /
+	                  options.Camera.FPS,
+	        .Levels = d_degradations.size() + 1,
+	    });
+	d_logger.Info(
+	    "degrading detection on overload",
+	    slog::Int("levels", d_degradations.size())
+	);
+}
+
+void ProcessFrameTask::SetUpProfiling(const ProcessOptions &options) {
+	if (options.TraceFile.empty()) {
+		return;
+	}
+	d_profiler = d_executor.make_observer<TaskflowProfiler>(
+	    options.TraceFile,
+	    options.TraceSkip,
+	    options.TraceFrames
+	);
+	d_logger.Info(
+	    "will trace taskflow",
+	    slog::String("path", options.TraceFile),
+	    slog::Int("skip", options.TraceSkip),
+	    slog::Int("frames", options.TraceFrames)
+	);
 }
 
 void ProcessFrameTask::SetUpUserInterface(
@@ -305,6 +521,94 @@ void ProcessFrameTask::SetUpUserInterface(
 	d_wantedROI = d_userInterface->DefaultROI();
 }
 
+void ProcessFrameTask::RegisterMetrics(const MetricsPtr &metrics) {
+	d_metrics = metrics;
+
+	// all samplers only read values maintained anyway.
+	metrics->AddCounter(
+	    "artemis_frames_total",
+	    "Frames by outcome of their processing",
+	    [this]() { return d_frameProcessed.load(); },
+	    {{"outcome", "processed"}}
+	);
+	metrics->AddCounter(
+	    "artemis_frames_total",
+	    "Frames by outcome of their processing",
+	    [this]() { return d_frameDropped.load(); },
+	    {{"outcome", "dropped"}}
+	);
+	metrics->AddGauge(
+	    "artemis_frame_queue_depth",
+	    "Frames acquired and waiting to be processed",
+	    [this]() { return d_frameQueue.size_approx(); }
+	);
+	metrics->AddGauge(
+	    "artemis_frames_in_flight",
+	    "Frames being processed",
+	    [this]() { return d_waitingFrames.load(); }
+	);
+	metrics->AddGauge(
+	    "artemis_degradation_level",
+	    "Current level of degradation of the processing on overload",
+	    [this]() { return d_degradationLevel.load(); }
+	);
+
+	for (size_t i = 0; i < FrameLatency::NUM_STAGES; ++i) {
+		const auto stage = FrameLatency::Stage(i);
+		metrics->AddHistogram(
+		    "artemis_frame_latency_seconds",
+		    "Time spent by frames in each stage, from acquisition to network",
+		    [latency = d_latency, stage]() { return latency->Read(stage); },
+		    {{"stage", FrameLatency::StageName(stage)}}
+		);
+	}
+
+	const auto addPool = [&metrics](const std::string &name, auto pool) {
+		metrics->AddGauge(
+		    "artemis_pool_objects",
+		    "Objects allocated by memory pools, by state",
+		    [pool]() { return pool->GetStats().Allocated; },
+		    {{"pool", name}, {"state", "allocated"}}
+		);
+		metrics->AddGauge(
+		    "artemis_pool_objects",
+		    "Objects allocated by memory pools, by state",
+		    [pool]() { return pool->GetStats().Available; },
+		    {{"pool", name}, {"state", "available"}}
+		);
+	};
+	addPool("image", d_imagePool);
+	addPool("message", d_messagePool);
+
+	if (d_video) {
+		metrics->AddCounter(
+		    "artemis_video_output_frames_total",
+		    "Frames sent to video output by outcome",
+		    [this]() { return d_video->GetStats().Processed; },
+		    {{"outcome", "processed"}}
+		);
+		metrics->AddCounter(
+		    "artemis_video_output_frames_total",
+		    "Frames sent to video output by outcome",
+		    [this]() { return d_video->GetStats().Dropped; },
+		    {{"outcome", "dropped"}}
+		);
+		metrics->AddCounter(
+		    "artemis_video_output_reconnections_total",
+		    "Reconnections of the video output stream",
+		    [this]() { return d_video->GetStats().Reconnections; }
+		);
+	}
+
+	if (d_connection) {
+		metrics->AddGauge(
+		    "artemis_leto_queue_depth",
+		    "Readouts waiting to be sent to leto",
+		    [this]() { return d_connection->QueueSize(); }
+		);
+	}
+}
+
 ProcessFrameTask::~ProcessFrameTask() {}
 
 void ProcessFrameTask::TearDown() {
@@ -312,6 +616,9 @@ void ProcessFrameTask::TearDown() {
 		d_userInterface->CloseQueue();
 	}
 	if (d_connection) {
+		if (d_metrics) {
+			d_metrics->Remove("artemis_leto_queue_depth");
+		}
 		d_connection->Close();
 		// will block until connection is closed to avoid complete lock.
 		d_connection.reset();
@@ -327,23 +634,50 @@ void ProcessFrameTask::Run() {
 	d_frameDropped   = 0;
 	d_frameProcessed = 0;
 	d_start          = Time::Now();
-	for (;;) {
-		d_frameQueue.wait_dequeue(d_current.Frame);
-		if (!d_current.Frame) {
+	for (size_t i = 0;; ++i) {
+		Frame::Ptr frame;
+		d_frameQueue.wait_dequeue(frame);
+		if (!frame) {
 			break;
 		}
-
-		d_executor.run(d_taskflow).wait();
-
-		// release all memory from here.
-		d_current.Frame = nullptr;
+		// frames are stamped when built by the grabber, as it returns them.
+		const auto dequeued = Time::Now();
+		d_latency->Record(FrameLatency::Stage::Queue, frame->Time(), dequeued);
+		d_latency->Report(dequeued);
+		auto &slot = *d_slots[i % d_slots.size()];
+		// waits until the previous frame of this slot is done.
+		if (slot.Done.valid()) {
+			slot.Done.wait();
+		}
+		if (d_profiler != nullptr) {
+			d_profiler->FrameStarted(frame->ID());
+		}
+		slot.Data.Frame       = std::move(frame);
+		slot.Data.Dequeued    = dequeued;
+		slot.Data.DetectStart = std::nullopt;
+		slot.Data.Detected    = std::nullopt;
+		++d_waitingFrames;
+		Launch(slot);
+	}
+	for (auto &slot : d_slots) {
+		if (slot->Done.valid()) {
+			slot->Done.wait();
+		}
+	}
+	d_lastAdmit.reset();
+	for (auto &h : d_lastHeads) {
+		h.reset();
+	}
+	d_lastTail.reset();
+	if (d_profiler != nullptr) {
+		d_profiler->Flush();
 	}
 	d_logger.Info("tear down");
 	TearDown();
 	d_logger.Info("end");
 }
 
-void ProcessFrameTask::DropFrame(const Frame::Ptr &frame) {
+void ProcessFrameTask::DropFrame(ProcessedData &data) {
 	++d_frameDropped;
 	d_logger.Warn(
 	    "frame dropped due to over-processing",
@@ -355,13 +689,8 @@ void ProcessFrameTask::DropFrame(const Frame::Ptr &frame) {
 	    )
 	);
 
-	if (!d_connection) {
-		return;
-	}
-
-	d_current.Readout->set_error(hermes::FrameReadout::PROCESS_OVERFLOW);
-
-	d_connection->PostMessage(*d_current.Readout, frame->ID());
+	// posted by the tail, so it stays in order with the processed frames.
+	data.Readout->set_error(hermes::FrameReadout::PROCESS_OVERFLOW);
 }
 
 void ProcessFrameTask::ProcessFrame(const Frame::Ptr &frame) {}
@@ -385,6 +714,86 @@ bool ProcessFrameTask::ShouldProcess(uint64_t ID) {
 	return d_config.FrameIDs.count(ID % d_config.FrameStride) != 0;
 }
 
+bool ProcessFrameTask::ShouldDrop() {
+	// frames waiting in a slot for their head to start are also queued.
+	const size_t queued = d_frameQueue.size_approx() + d_waitingFrames.load();
+	if (queued == 0) {
+		return false;
+	}
+	if (!d_degradation) {
+		return true;
+	}
+	return Degraded(Degradation::DropFrames) || queued >= MAX_QUEUED_FRAMES;
+}
+
+bool ProcessFrameTask::Degraded(Degradation degradation) const {
+	if (!d_degradation) {
+		return false;
+	}
+	// levels apply the degradations in order.
+	for (size_t i = 0; i < d_degradationLevel.load(); ++i) {
+		if (d_degradations[i] == degradation) {
+			return true;
+		}
+	}
+	return false;
+}
+
+size_t ProcessFrameTask::ApplyDegradation(size_t detector) {
+	const size_t level = d_degradationLevel.load();
+	if (!d_degradation || d_appliedLevels[detector] == level) {
+		return level;
+	}
+	d_appliedLevels[detector] = level;
+	d_detectors[detector]->SetRefineEdges(
+	    d_config.RefineEdges && !Degraded(Degradation::SkipRefineEdges)
+	);
+	d_detectors[detector]->SetQuadDecimate(
+	    Degraded(Degradation::RaiseDecimation) ? d_config.QuadDecimate + 1.0f
+	                                           : d_config.QuadDecimate
+	);
+	return level;
+}
+
+void ProcessFrameTask::UpdateDegradation(
+    const ProcessedData &data, const Duration &processing
+) {
+	if (!d_degradation) {
+		return;
+	}
+	// hermes::FrameReadout has no field for it, the level of degraded frames
+	// is logged instead.
+	if (data.Degradation > 0) {
+		d_logger.Info(
+		    "degraded frame",
+		    slog::Int("frameID", data.Frame->ID()),
+		    slog::Int("level", data.Degradation)
+		);
+	}
+	const size_t previous = d_degradation->Level();
+	const size_t level    = d_degradation->Update(processing.Seconds());
+	d_degradationLevel.store(level);
+	if (level == previous) {
+		return;
+	}
+	static const char *names[] = {
+	    "skip-refine-edges",
+	    "raise-decimation",
+	    "tracked-only",
+	    "drop-frames",
+	};
+	d_logger.Info(
+	    "degradation level changed",
+	    slog::Int("frameID", data.Frame->ID()),
+	    slog::Int("level", level),
+	    slog::String(
+	        "degradation",
+	        level == 0 ? "none" : names[int(d_degradations[level - 1])]
+	    ),
+	    slog::Float("load", d_degradation->Load())
+	);
+}
+
 void ProcessFrameTask::QueueFrame(const Frame::Ptr &frame) {
 	d_frameQueue.enqueue(frame);
 }
@@ -457,18 +866,16 @@ void ProcessFrameTask::ExportROI(
 	image.GetROI(roi).WritePNG(d_config.CloseUpDir / oss.str());
 }
 
-void ProcessFrameTask::DisplayFrame(
-    const Frame::Ptr &frame, const std::shared_ptr<hermes::FrameReadout> &m
-) {
+void ProcessFrameTask::DisplayFrame(const ProcessedData &data) {
 
 	UserInterface::FrameToDisplay toDisplay = {
-	    .Full                 = d_current.Full,
-	    .Zoomed               = d_current.Zoomed,
-	    .Message              = m,
+	    .Full                 = data.Full,
+	    .Zoomed               = data.Zoomed,
+	    .Message              = data.Readout,
 	    .CurrentROI           = d_wantedROI,
-	    .FrameID              = d_current.Frame->ID(),
-	    .FrameTime            = frame->Time(),
-	    .FPS                  = CurrentFPS(frame->Time()),
+	    .FrameID              = data.Frame->ID(),
+	    .FrameTime            = data.Frame->Time(),
+	    .FPS                  = CurrentFPS(data.Frame->Time()),
 	    .FrameProcessed       = d_frameProcessed,
 	    .FrameDropped         = d_frameDropped,
 	    .VideoOutputProcessed = -1UL,
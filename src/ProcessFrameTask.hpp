@@ -6,6 +6,9 @@
 #include <cstdlib>
 #include <string>
 
+#include <future>
+#include <optional>
+
 #include <taskflow/core/executor.hpp>
 
 #include <slog++/Attribute.hpp>
@@ -19,6 +22,8 @@
 #include "Options.hpp"
 #include "Task.hpp"
 
+#include "utils/Partitions.hpp"
+
 #include "readerwriterqueue.h"
 
 namespace cv {
@@ -36,8 +41,18 @@ class Connection;
 typedef std::unique_ptr<Connection> ConnectionPtr;
 class ApriltagDetector;
 typedef std::unique_ptr<ApriltagDetector> ApriltagDetectorPtr;
+class TagTracker;
+typedef std::unique_ptr<TagTracker> TagTrackerPtr;
 class VideoOutput;
 typedef std::unique_ptr<VideoOutput> VideoOutputPtr;
+class DegradationPolicy;
+typedef std::unique_ptr<DegradationPolicy> DegradationPolicyPtr;
+class TaskflowProfiler;
+typedef std::shared_ptr<TaskflowProfiler> TaskflowProfilerPtr;
+class FrameLatency;
+typedef std::shared_ptr<FrameLatency> FrameLatencyPtr;
+class Metrics;
+typedef std::shared_ptr<Metrics> MetricsPtr;
 
 class ProcessFrameTask : public Task {
 public:
@@ -56,9 +71,47 @@ public:
 
 	UserInterfaceTaskPtr UserInterfaceTask() const;
 
+	// Exposes the frame counters, queues, pools and latencies in metrics.
+	// Must be called before Run().
+	void RegisterMetrics(const MetricsPtr &metrics);
+
 private:
 	typedef moodycamel::BlockingReaderWriterQueue<Frame::Ptr> FrameQueue;
 
+	// Ways to reduce the processing cost on overload, from the first to the
+	// last resort.
+	enum class Degradation {
+		SkipRefineEdges = 0,
+		RaiseDecimation,
+		TrackedOnly,
+		DropFrames,
+	};
+
+	// frames are dropped anyway if more are waiting.
+	constexpr static size_t MAX_QUEUED_FRAMES = 3;
+
+	struct ProcessedData {
+		artemis::Frame::Ptr                   Frame;
+		std::shared_ptr<hermes::FrameReadout> Readout;
+		std::shared_ptr<ImageU8>              Full, Zoomed;
+		// stages of the frame, stamped for the latency accounting.
+		std::optional<Time> Dequeued, DetectStart, Detected;
+		// degradation level the frame was detected with.
+		size_t Degradation = 0;
+	};
+
+	// A frame in flight. The head detects and tracks, the tail outputs the
+	// results.
+	struct Slot {
+		ProcessedData     Data;
+		size_t            Detector = 0;
+		// 0: process, 1: ignore, 2: drop.
+		int               Action = 0;
+		Duration          Processing;
+		tf::Taskflow      Head, Tail;
+		std::future<void> Done;
+	};
+
 	void SetUpVideoOutputTask(
 	    const VideoOutputOptions &options,
 	    const Size               &inputResolution,
@@ -78,11 +131,21 @@ private:
 
 	void SetUpConnection(const LetoOptions &options, GMainContext *context);
 
+	void SetUpDegradation(const Options &options);
+
+	void SetUpProfiling(const ProcessOptions &options);
+
 	void SetUpTaskflow();
+	void SetUpHead(Slot &slot);
+	void SetUpTail(Slot &slot);
+
+	void Launch(Slot &slot);
+	// Decides if the frame of slot is processed, ignored or dropped.
+	void Admit(Slot &slot);
 
 	void ProcessFrame(const Frame::Ptr &frame);
 
-	void DropFrame(const Frame::Ptr &frame);
+	void DropFrame(ProcessedData &data);
 
 	void Detect(const Frame::Ptr &frame, hermes::FrameReadout &m);
 
@@ -108,9 +171,7 @@ private:
 	// this method copies its pointer to avoid an early invalidation of frame
 	void ExportFullFrame(Frame::Ptr frame);
 
-	void DisplayFrame(
-	    const Frame::Ptr &frame, const std::shared_ptr<hermes::FrameReadout> &m
-	);
+	void DisplayFrame(const ProcessedData &data);
 
 	void TearDown();
 
@@ -118,6 +179,16 @@ private:
 
 	bool ShouldProcess(uint64_t ID);
 
+	bool ShouldDrop();
+
+	bool Degraded(Degradation degradation) const;
+
+	// Returns the level applied to the detector.
+	size_t ApplyDegradation(size_t detector);
+
+	void
+	UpdateDegradation(const ProcessedData &data, const Duration &processing);
+
 	double CurrentFPS(const Time &time);
 
 	// const ProcessOptions d_options;
@@ -129,6 +200,9 @@ private:
 		Duration              ImageRenewPeriod;
 		std::filesystem::path CloseUpDir;
 		size_t                CloseUpSize;
+		bool                  RefineEdges;
+		float                 QuadDecimate;
+		size_t                ParallelFrames;
 
 		Config(const Options &options)
 		    : UUID{options.Process.UUID}
@@ -136,7 +210,10 @@ private:
 		    , FrameIDs{options.Process.FrameIDs()}
 		    , ImageRenewPeriod{options.RenewPeriod}
 		    , CloseUpDir{options.CloseUpOutputDir}
-		    , CloseUpSize{options.CloseUpROISize} {}
+		    , CloseUpSize{options.CloseUpROISize}
+		    , RefineEdges{options.Apriltag.RefineEdges}
+		    , QuadDecimate{options.Apriltag.QuadDecimate}
+		    , ParallelFrames{options.Process.ParallelFrames} {}
 	};
 
 	using ImagePool = utils::ObjectPool<
@@ -145,12 +222,6 @@ private:
 	    ImageU8::OwnedMemoryDeleter>;
 	using MessagePool = utils::ObjectPool<hermes::FrameReadout>;
 
-	struct ProcessedData {
-		artemis::Frame::Ptr                   Frame;
-		std::shared_ptr<hermes::FrameReadout> Readout;
-		std::shared_ptr<ImageU8>              Full, Zoomed;
-	};
-
 	Config d_config;
 
 	FrameQueue d_frameQueue;
@@ -191,7 +262,18 @@ private:
 	const size_t        d_maximumThreads;
 	std::atomic<size_t> d_actualThreads;
 
-	ApriltagDetectorPtr d_detector;
+	std::vector<ApriltagDetectorPtr> d_detectors;
+	size_t                           d_detectorThreads = 0;
+	TagTrackerPtr                    d_tracker;
+	Partition                        d_trackedROIs;
+
+	FrameLatencyPtr d_latency;
+	MetricsPtr      d_metrics;
+
+	DegradationPolicyPtr     d_degradation;
+	std::vector<Degradation> d_degradations;
+	std::atomic<size_t>      d_degradationLevel = 0;
+	std::vector<size_t>      d_appliedLevels;
 
 	Time               d_nextFrameExport;
 	Time               d_nextTagCatalog;
@@ -202,10 +284,15 @@ private:
 	std::atomic<size_t> d_frameDropped = 0, d_frameProcessed = 0;
 	Time                d_start;
 
-	tf::Executor    d_executor;
-	slog::Logger<1> d_logger;
-	ProcessedData   d_current;
-	tf::Taskflow    d_taskflow;
+	std::shared_ptr<hermes::FrameReadout> d_lastReadout;
+	std::atomic<size_t>                   d_waitingFrames = 0;
+
+	tf::Executor                       d_executor;
+	TaskflowProfilerPtr                d_profiler;
+	slog::Logger<1>                    d_logger;
+	std::vector<std::unique_ptr<Slot>> d_slots;
+	tf::AsyncTask                      d_lastAdmit, d_lastTail;
+	std::vector<tf::AsyncTask>         d_lastHeads;
 };
 
 } // namespace artemis
@@ -0,0 +1,385 @@
+#include "QuadVerifier.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include <Eigen/Dense>
+
+namespace fort {
+namespace artemis {
+
+namespace {
+// order of apriltag_detection_t::p in tag coordinates.
+constexpr double TAG_CORNERS[4][2] = {{-1, 1}, {1, 1}, {1, -1}, {-1, -1}};
+
+constexpr int MAX_SEARCH_RADIUS = 16;
+
+// Same sampling convention than apriltag's value_for_pixel().
+bool sample(const ImageU8 &image, double px, double py, double &value) {
+	double x = px - 0.5, y = py - 0.5;
+	int    x1 = std::floor(x), y1 = std::floor(y);
+	if (x1 < 0 || y1 < 0 || x1 + 1 >= image.width || y1 + 1 >= image.height) {
+		return false;
+	}
+	double a = x - x1, b = y - y1;
+	value    = (1 - a) * (1 - b) * image.at(x1, y1) +
+	        a * (1 - b) * image.at(x1 + 1, y1) +
+	        (1 - a) * b * image.at(x1, y1 + 1) + a * b * image.at(x1 + 1, y1 + 1);
+	return true;
+}
+
+void computeHomography(const double corners[4][2], double H[9]) {
+	Eigen::Matrix<double, 8, 8> A;
+	Eigen::Matrix<double, 8, 1> b;
+	for (int i = 0; i < 4; ++i) {
+		double x = TAG_CORNERS[i][0], y = TAG_CORNERS[i][1];
+		double u = corners[i][0], v = corners[i][1];
+		A.row(2 * i) << x, y, 1, 0, 0, 0, -u * x, -u * y;
+		A.row(2 * i + 1) << 0, 0, 0, x, y, 1, -v * x, -v * y;
+		b(2 * i)     = u;
+		b(2 * i + 1) = v;
+	}
+	Eigen::Matrix<double, 8, 1> h = A.partialPivLu().solve(b);
+	for (int i = 0; i < 8; ++i) {
+		H[i] = h(i);
+	}
+	H[8] = 1.0;
+}
+
+Eigen::Vector2d project(const double H[9], double x, double y) {
+	double z = H[6] * x + H[7] * y + H[8];
+	return {(H[0] * x + H[1] * y + H[2]) / z, (H[3] * x + H[4] * y + H[5]) / z};
+}
+
+// A line as a point and a unit direction.
+typedef std::pair<Eigen::Vector2d, Eigen::Vector2d> Line;
+
+bool intersect(const Line &a, const Line &b, Eigen::Vector2d &result) {
+	Eigen::Matrix2d M;
+	M.col(0) = a.second;
+	M.col(1) = -b.second;
+	if (std::abs(M.determinant()) < 1e-6) {
+		return false;
+	}
+	Eigen::Vector2d ts = M.inverse() * (b.first - a.first);
+	result             = a.first + ts(0) * a.second;
+	return true;
+}
+
+} // namespace
+
+bool QuadVerifier::Supports(const apriltag_family_t *family) {
+	return family->reversed_border == false &&
+	       family->total_width == family->width_at_border + 2;
+}
+
+QuadVerifier::QuadVerifier(
+    const apriltag_family_t *family,
+    int                      maxHamming,
+    int                      minBlackWhiteDiff,
+    int                      searchRadius
+)
+    : d_family{family}
+    , d_maxHamming{maxHamming}
+    , d_minBlackWhiteDiff{minBlackWhiteDiff}
+    , d_searchRadius{std::clamp(searchRadius, 2, MAX_SEARCH_RADIUS)} {}
+
+bool QuadVerifier::refineEdges(
+    const ImageU8 &image, Quad &corners, int radius
+) const {
+	Eigen::Vector2d c[4], center{0, 0};
+	for (int i = 0; i < 4; ++i) {
+		c[i] = {corners[i][0], corners[i][1]};
+		center += c[i] / 4.0;
+	}
+
+	std::array<double, 2 * MAX_SEARCH_RADIUS + 1> values;
+	const double minGradient = d_minBlackWhiteDiff / 4.0;
+
+	Line lines[4];
+	for (int e = 0; e < 4; ++e) {
+		const auto  &a   = c[e];
+		const auto  &b   = c[(e + 1) % 4];
+		const double len = (b - a).norm();
+		if (len < 4.0) {
+			return false;
+		}
+		Eigen::Vector2d d = (b - a) / len;
+		Eigen::Vector2d n{-d.y(), d.x()};
+		// the border is black inside and white outside.
+		if (n.dot((a + b) / 2.0 - center) < 0) {
+			n = -n;
+		}
+
+		const int       nSamples = std::clamp(int(len / 4), 4, 32);
+		Eigen::Vector2d mean{0, 0};
+		Eigen::Matrix2d moments = Eigen::Matrix2d::Zero();
+		int             count   = 0;
+		for (int k = 0; k < nSamples; ++k) {
+			// stays away from the corners, which are the least accurate.
+			double          t = 0.15 + 0.7 * (k + 0.5) / nSamples;
+			Eigen::Vector2d p = a + t * (b - a);
+			for (int s = -radius; s <= radius; ++s) {
+				Eigen::Vector2d q = p + s * n;
+				if (sample(image, q.x(), q.y(), values[s + radius]) == false) {
+					return false;
+				}
+			}
+			int    best = -1;
+			double bestGradient{minGradient};
+			for (int s = 0; s < 2 * radius; ++s) {
+				double g = values[s + 1] - values[s];
+				if (g > bestGradient) {
+					best         = s;
+					bestGradient = g;
+				}
+			}
+			if (best < 0) {
+				continue;
+			}
+			double weights{0}, position{0};
+			for (int s = std::max(0, best - 1);
+			     s <= std::min(2 * radius - 1, best + 1);
+			     ++s) {
+				double g = std::max(0.0, values[s + 1] - values[s]);
+				weights += g;
+				position += g * (s + 0.5 - radius);
+			}
+			Eigen::Vector2d edge = p + (position / weights) * n;
+			mean += edge;
+			moments += edge * edge.transpose();
+			++count;
+		}
+		if (count < 3) {
+			return false;
+		}
+		mean /= count;
+		Eigen::Matrix2d cov   = moments / count - mean * mean.transpose();
+		double          theta = 0.5 * std::atan2(
+                                     2 * cov(0, 1),
+                                     cov(0, 0) - cov(1, 1)
+                                 );
+		lines[e]              = {mean, {std::cos(theta), std::sin(theta)}};
+	}
+
+	for (int i = 0; i < 4; ++i) {
+		Eigen::Vector2d corner;
+		if (intersect(lines[(i + 3) % 4], lines[i], corner) == false ||
+		    (corner - c[i]).norm() > 2 * radius) {
+			return false;
+		}
+		corners[i][0] = corner.x();
+		corners[i][1] = corner.y();
+	}
+	return true;
+}
+
+bool QuadVerifier::decode(
+    const ImageU8 &image, const Quad &corners, uint32_t ID, double H[9]
+) const {
+	if (ID >= d_family->ncodes) {
+		return false;
+	}
+	computeHomography(corners, H);
+
+	const int W         = d_family->width_at_border;
+	auto      cellValue = [&](double cx, double cy, double &value) {
+        auto p = project(
+            H,
+            2 * ((cx + 0.5) / W - 0.5),
+            2 * ((cy + 0.5) / W - 0.5)
+        );
+        return sample(image, p.x(), p.y(), value);
+	};
+
+	// the black border and the white ring around it gives the threshold.
+	double black{0}, white{0}, value;
+	for (int i = 0; i < W; ++i) {
+		for (const auto &[x, y] : {
+		         std::pair<int, int>{i, 0},
+		         {i, W - 1},
+		         {0, i},
+		         {W - 1, i},
+		     }) {
+			if (cellValue(x, y, value) == false) {
+				return false;
+			}
+			black += value;
+		}
+	}
+	for (int i = -1; i <= W; ++i) {
+		for (const auto &[x, y] : {
+		         std::pair<int, int>{i, -1},
+		         {i, W},
+		         {-1, i},
+		         {W, i},
+		     }) {
+			if (cellValue(x, y, value) == false) {
+				return false;
+			}
+			white += value;
+		}
+	}
+	black /= 4 * W;
+	white /= 4 * (W + 2);
+	if (white - black < d_minBlackWhiteDiff) {
+		return false;
+	}
+	const double threshold = (black + white) / 2.0;
+
+	// the corners are in the detection orientation, the code orientation is
+	// one of the four rotations.
+	for (int rotation = 0; rotation < 4; ++rotation) {
+		uint64_t rcode = 0;
+		for (uint32_t i = 0; i < d_family->nbits; ++i) {
+			double x = d_family->bit_x[i] + 0.5 - W / 2.0;
+			double y = d_family->bit_y[i] + 0.5 - W / 2.0;
+			for (int r = 0; r < rotation; ++r) {
+				std::tie(x, y) = std::make_pair(-y, x);
+			}
+			if (cellValue(x + W / 2.0 - 0.5, y + W / 2.0 - 0.5, value) ==
+			    false) {
+				return false;
+			}
+			rcode = (rcode << 1) | (value > threshold ? 1 : 0);
+		}
+		if (__builtin_popcountll(rcode ^ d_family->codes[ID]) <=
+		    d_maxHamming) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void QuadVerifier::Verify(
+    const ImageU8 &image, uint64_t frameID, size_t worker, size_t workers
+) {
+	for (size_t i = worker; i < d_tracks.size(); i += workers) {
+		const auto &t        = d_tracks[i];
+		auto       &result   = d_results[i];
+		const double elapsed = double(frameID) - double(t.FrameID);
+
+		Quad corners;
+		result.Predicted = {0, 0};
+		for (int c = 0; c < 4; ++c) {
+			corners[c][0] = t.Corners[c][0] + t.VX * elapsed;
+			corners[c][1] = t.Corners[c][1] + t.VY * elapsed;
+			result.Predicted += Eigen::Vector2d{corners[c][0], corners[c][1]};
+		}
+		result.Predicted /= 4.0;
+
+		double H[9];
+		result.Verified =
+		    refineEdges(image, corners, d_searchRadius) &&
+		    refineEdges(image, corners, std::max(2, d_searchRadius / 4)) &&
+		    decode(image, corners, t.ID, H);
+		if (result.Verified == false) {
+			continue;
+		}
+
+		auto tagCenter          = project(H, 0, 0);
+		result.Detection.ID     = t.ID;
+		result.Detection.X      = tagCenter.x();
+		result.Detection.Y      = tagCenter.y();
+		result.Detection.Theta  = 0.0;
+		std::copy(
+		    &corners[0][0],
+		    &corners[0][0] + 8,
+		    &result.Detection.Corners[0][0]
+		);
+	}
+}
+
+void QuadVerifier::Collect(
+    DetectionMerger::List &verified, std::vector<Eigen::Vector2d> &lost
+) const {
+	for (const auto &r : d_results) {
+		if (r.Verified) {
+			verified.push_back(r.Detection);
+		} else {
+			lost.push_back(r.Predicted);
+		}
+	}
+}
+
+void QuadVerifier::SelectWindows(
+    const Partition &windows, Partition &result
+) const {
+	auto contains = [](const Rect &r, double x, double y) {
+		return x >= r.x() && x < r.x() + r.width() && y >= r.y() &&
+		       y < r.y() + r.height();
+	};
+	for (const auto &w : windows) {
+		bool verified{false}, lost{false};
+		for (const auto &r : d_results) {
+			if (r.Verified) {
+				verified = verified || contains(w, r.Detection.X, r.Detection.Y);
+			} else {
+				lost = lost || contains(w, r.Predicted.x(), r.Predicted.y());
+			}
+		}
+		// a window without a verified tag may hold a tag the verifier does
+		// not know anymore.
+		if (verified == false || lost) {
+			result.push_back(w);
+		}
+	}
+}
+
+void QuadVerifier::Update(
+    uint64_t frameID, const DetectionMerger::List &detections, bool complete
+) {
+	auto byID = [](const Track &a, const Track &b) { return a.ID < b.ID; };
+
+	d_nextTracks.clear();
+	for (const auto &d : detections) {
+		Track t{.ID = d.ID, .VX = 0.0, .VY = 0.0, .FrameID = frameID};
+		std::copy(&d.Corners[0][0], &d.Corners[0][0] + 8, &t.Corners[0][0]);
+		d_nextTracks.push_back(t);
+	}
+	std::sort(d_nextTracks.begin(), d_nextTracks.end(), byID);
+	const auto found = d_nextTracks.size();
+
+	// motion is only estimated for IDs seen once in both frames.
+	for (auto it = d_nextTracks.begin(); it != d_nextTracks.end();) {
+		auto next = std::upper_bound(it, d_nextTracks.end(), *it, byID);
+		auto [first, last] =
+		    std::equal_range(d_tracks.begin(), d_tracks.end(), *it, byID);
+		if (next - it == 1 && last - first == 1 &&
+		    first->FrameID < frameID) {
+			double elapsed = double(frameID) - double(first->FrameID);
+			for (int c = 0; c < 4; ++c) {
+				it->VX += (it->Corners[c][0] - first->Corners[c][0]) / 4.0;
+				it->VY += (it->Corners[c][1] - first->Corners[c][1]) / 4.0;
+			}
+			it->VX /= elapsed;
+			it->VY /= elapsed;
+		}
+		it = next;
+	}
+
+	if (complete == false) {
+		for (const auto &t : d_tracks) {
+			if (std::binary_search(
+			        d_nextTracks.begin(),
+			        d_nextTracks.begin() + found,
+			        t,
+			        byID
+			    ) == false) {
+				d_nextTracks.push_back(t);
+			}
+		}
+		std::sort(d_nextTracks.begin(), d_nextTracks.end(), byID);
+	}
+
+	d_tracks.swap(d_nextTracks);
+	d_results.resize(d_tracks.size());
+}
+
+size_t QuadVerifier::TrackCount() const {
+	return d_tracks.size();
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <apriltag/apriltag.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "ImageU8.hpp"
+#include "utils/DetectionMerger.hpp"
+#include "utils/Partitions.hpp"
+
+namespace fort {
+namespace artemis {
+
+// Re-identifies the tags of the previous frame without searching for quads:
+// their corners are moved by their last motion, refined on the image
+// gradient, and the code bits are sampled through the resulting homography.
+class QuadVerifier {
+public:
+	// Returns true if the family has a square black border the verifier can
+	// refine on.
+	static bool Supports(const apriltag_family_t *family);
+
+	QuadVerifier(
+	    const apriltag_family_t *family,
+	    int                      maxHamming,
+	    int                      minBlackWhiteDiff,
+	    int                      searchRadius
+	);
+
+	// Verifies the tags of worker, worker + workers, ... at frameID. Calls
+	// for different workers may run concurrently.
+	void Verify(
+	    const ImageU8 &image, uint64_t frameID, size_t worker, size_t workers
+	);
+
+	// Returns the tags verified by all workers, and the predicted position
+	// of the ones that failed.
+	void Collect(
+	    DetectionMerger::List        &verified,
+	    std::vector<Eigen::Vector2d> &lost
+	) const;
+
+	// Returns the windows that still need a full detection: the ones
+	// without a verified tag, and the ones around a lost tag.
+	void SelectWindows(const Partition &windows, Partition &result) const;
+
+	// Stores the detections of frameID for the next frames. If complete, the
+	// detections cover the whole frame and the tags they miss are forgotten,
+	// otherwise these tags are kept with their last motion.
+	void Update(
+	    uint64_t frameID, const DetectionMerger::List &detections, bool complete
+	);
+
+	size_t TrackCount() const;
+
+private:
+	typedef double Quad[4][2];
+
+	struct Track {
+		uint32_t ID;
+		Quad     Corners;
+		double   VX, VY;
+		uint64_t FrameID;
+	};
+
+	struct Result {
+		bool                       Verified;
+		DetectionMerger::Detection Detection;
+		Eigen::Vector2d            Predicted;
+	};
+
+	bool refineEdges(const ImageU8 &image, Quad &corners, int radius) const;
+
+	bool decode(
+	    const ImageU8 &image, const Quad &corners, uint32_t ID, double H[9]
+	) const;
+
+	const apriltag_family_t *d_family;
+	const int                d_maxHamming;
+	const int                d_minBlackWhiteDiff;
+	const int                d_searchRadius;
+
+	std::vector<Track>  d_tracks, d_nextTracks;
+	std::vector<Result> d_results;
+};
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include "QuadVerifier.hpp"
+
+#include <apriltag/tag16h5.h>
+
+#include <cstring>
+
+namespace fort {
+namespace artemis {
+
+class QuadVerifierTest : public ::testing::Test {
+protected:
+	void SetUp() {
+		d_family = tag16h5_create();
+		d_data.resize(320 * 300);
+		d_image = ImageU8{300, 300, d_data.data(), 320};
+	}
+
+	void TearDown() {
+		tag16h5_destroy(d_family);
+	}
+
+	// Renders tag ID scaled 12 times with its top left corner at (x,y).
+	void render(uint32_t ID, int x, int y) {
+		memset(d_data.data(), 255, d_data.size());
+		auto tag = apriltag_to_image(d_family, ID);
+		for (int iy = 0; iy < 12 * tag->height; ++iy) {
+			for (int ix = 0; ix < 12 * tag->width; ++ix) {
+				d_image.at(x + ix, y + iy) =
+				    tag->buf[(iy / 12) * tag->stride + ix / 12];
+			}
+		}
+		image_u8_destroy(tag);
+	}
+
+	DetectionMerger::List detect() {
+		auto td = apriltag_detector_create();
+		apriltag_detector_add_family(td, d_family);
+		image_u8_t img{
+		    .width  = d_image.width,
+		    .height = d_image.height,
+		    .stride = d_image.stride,
+		    .buf    = d_image.buffer,
+		};
+		auto detections = apriltag_detector_detect(td, &img);
+
+		DetectionMerger::List res;
+		for (int i = 0; i < zarray_size(detections); ++i) {
+			apriltag_detection_t *q;
+			zarray_get(detections, i, &q);
+			DetectionMerger::Detection d{
+			    .ID = uint32_t(q->id),
+			    .X  = q->c[0],
+			    .Y  = q->c[1],
+			};
+			memcpy(d.Corners, q->p, sizeof(d.Corners));
+			res.push_back(d);
+		}
+		apriltag_detections_destroy(detections);
+		apriltag_detector_destroy(td);
+		return res;
+	}
+
+	apriltag_family_t   *d_family;
+	std::vector<uint8_t> d_data;
+	ImageU8              d_image;
+};
+
+TEST_F(QuadVerifierTest, VerifiesMovingTag) {
+	ASSERT_TRUE(QuadVerifier::Supports(d_family));
+	QuadVerifier verifier{d_family, 2, 40, 8};
+
+	render(7, 100, 100);
+	auto first = detect();
+	ASSERT_EQ(first.size(), 1);
+	verifier.Update(1, first, true);
+	EXPECT_EQ(verifier.TrackCount(), 1);
+
+	DetectionMerger::List        verified;
+	std::vector<Eigen::Vector2d> lost;
+
+	render(7, 103, 98);
+	auto expected = detect();
+	ASSERT_EQ(expected.size(), 1);
+	verifier.Verify(d_image, 2, 0, 1);
+	verifier.Collect(verified, lost);
+	ASSERT_EQ(verified.size(), 1);
+	EXPECT_TRUE(lost.empty());
+	EXPECT_EQ(verified[0].ID, 7);
+	EXPECT_NEAR(verified[0].X, expected[0].X, 0.5);
+	EXPECT_NEAR(verified[0].Y, expected[0].Y, 0.5);
+
+	// a different tag at the same place is not confirmed.
+	render(8, 103, 98);
+	verified.clear();
+	verifier.Verify(d_image, 2, 0, 1);
+	verifier.Collect(verified, lost);
+	EXPECT_TRUE(verified.empty());
+	ASSERT_EQ(lost.size(), 1);
+	EXPECT_NEAR(lost[0].x(), first[0].X, 0.5);
+}
+
+TEST_F(QuadVerifierTest, RetriesTagsMissedBetweenSweeps) {
+	QuadVerifier verifier{d_family, 2, 40, 8};
+	// the tracking window around the tag, and one without any.
+	const Partition windows = {
+	    Rect{{60, 60}, {160, 160}},
+	    Rect{{0, 0}, {40, 40}},
+	};
+
+	render(7, 100, 100);
+	auto detections = detect();
+	ASSERT_EQ(detections.size(), 1);
+	verifier.Update(1, detections, true);
+
+	auto verifyFrame = [&](uint64_t frameID) {
+		DetectionMerger::List        verified;
+		std::vector<Eigen::Vector2d> lost;
+		Partition                    selected;
+		verifier.Verify(d_image, frameID, 0, 1);
+		verifier.Collect(verified, lost);
+		verifier.SelectWindows(windows, selected);
+		return std::make_pair(verified.size(), selected);
+	};
+
+	// verified tags need no detection.
+	auto [verified, selected] = verifyFrame(2);
+	EXPECT_EQ(verified, 1);
+	ASSERT_EQ(selected.size(), 1);
+	EXPECT_EQ(selected[0], windows[1]);
+	verifier.Update(2, detections, false);
+
+	// the tag disappears for two frames, its window is searched each time.
+	memset(d_data.data(), 255, d_data.size());
+	for (uint64_t frameID : {3, 4}) {
+		std::tie(verified, selected) = verifyFrame(frameID);
+		EXPECT_EQ(verified, 0) << "frame " << frameID;
+		EXPECT_EQ(selected, windows) << "frame " << frameID;
+		verifier.Update(frameID, detect(), false);
+		EXPECT_EQ(verifier.TrackCount(), 1) << "frame " << frameID;
+	}
+
+	// it comes back before the next sweep.
+	render(7, 100, 100);
+	std::tie(verified, selected) = verifyFrame(5);
+	EXPECT_EQ(verified, 1);
+	EXPECT_EQ(selected.size(), 1);
+
+	// a sweep forgets the tags it does not find.
+	verifier.Update(6, {}, true);
+	EXPECT_EQ(verifier.TrackCount(), 0);
+	std::tie(verified, selected) = verifyFrame(7);
+	EXPECT_EQ(selected, windows);
+}
+
+} // namespace artemis
+} // namespace fort
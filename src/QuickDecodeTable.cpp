@@ -0,0 +1,327 @@
+#include "QuickDecodeTable.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <fort/time/Time.hpp>
+#include <fort/utils/Defer.hpp>
+
+#include <slog++/slog++.hpp>
+
+namespace fort {
+namespace artemis {
+
+namespace details {
+// Mirrors the private quick decode layout of apriltag.c. Any change of it
+// upstream is caught by checkLayout(), which looks codes up through it.
+struct QuickDecodeEntry {
+	uint64_t rcode;
+	uint16_t id;
+	uint8_t  hamming;
+	uint8_t  rotation;
+};
+
+struct QuickDecode {
+	int               nentries;
+	QuickDecodeEntry *entries;
+};
+
+static_assert(sizeof(QuickDecodeEntry) == 16);
+
+struct CacheHeader {
+	char     Magic[8];
+	uint32_t EntrySize;
+	uint32_t BitsCorrected;
+	uint32_t NCodes;
+	uint32_t NBits;
+	uint64_t CodesHash;
+	uint64_t NEntries;
+	// keeps entries aligned on a page for the mapping.
+	char Padding[4096 - 40];
+};
+
+static_assert(sizeof(CacheHeader) == 4096);
+
+constexpr static char MAGIC[8] = "ARTQDT1";
+
+uint64_t hashCodes(const apriltag_family_t *family) {
+	// FNV-1a
+	uint64_t h = 0xcbf29ce484222325ULL;
+	for (uint32_t i = 0; i < family->ncodes; ++i) {
+		uint64_t code = family->codes[i];
+		for (size_t b = 0; b < sizeof(code); ++b) {
+			h ^= (code >> (8 * b)) & 0xff;
+			h *= 0x100000001b3ULL;
+		}
+	}
+	return h;
+}
+
+uint64_t expectedEntries(const apriltag_family_t *family, int bitsCorrected) {
+	uint64_t nbits    = family->nbits;
+	uint64_t capacity = family->ncodes;
+	if (bitsCorrected >= 1) {
+		capacity += family->ncodes * nbits;
+	}
+	if (bitsCorrected >= 2) {
+		capacity += family->ncodes * nbits * (nbits - 1);
+	}
+	if (bitsCorrected >= 3) {
+		capacity += family->ncodes * nbits * (nbits - 1) * (nbits - 2);
+	}
+	return 3 * capacity;
+}
+
+// Same lookup than apriltag's quick_decode_codeword().
+const QuickDecodeEntry *lookup(const QuickDecode &qd, uint64_t rcode) {
+	for (int i = 0; i < qd.nentries; ++i) {
+		const auto &e = qd.entries[(rcode + i) % qd.nentries];
+		if (e.rcode == rcode) {
+			return &e;
+		}
+		if (e.rcode == UINT64_MAX) {
+			return nullptr;
+		}
+	}
+	return nullptr;
+}
+
+// Checks that codes and their one bit errors are found where apriltag would
+// look for them. Only a sample of the codes is checked, as a mapped table
+// may not be in memory yet.
+bool checkLayout(
+    const apriltag_family_t *family, int bitsCorrected, const QuickDecode *qd
+) {
+	constexpr static uint32_t SAMPLES = 64;
+	if (qd == nullptr ||
+	    uint64_t(qd->nentries) != expectedEntries(family, bitsCorrected)) {
+		return false;
+	}
+	const uint32_t step = std::max(family->ncodes / SAMPLES, 1U);
+	for (uint32_t id = 0; id < family->ncodes; id += step) {
+		const uint64_t code = family->codes[id];
+		auto           e    = lookup(*qd, code);
+		if (e == nullptr || e->id != id || e->hamming != 0) {
+			return false;
+		}
+		if (bitsCorrected < 1) {
+			continue;
+		}
+		const uint64_t flipped = code ^ (1ULL << (id % family->nbits));
+		e                      = lookup(*qd, flipped);
+		if (e == nullptr || e->id != id || e->hamming != 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+CacheHeader
+makeHeader(const apriltag_family_t *family, int bitsCorrected) {
+	CacheHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.Magic, MAGIC, sizeof(MAGIC));
+	header.EntrySize     = sizeof(QuickDecodeEntry);
+	header.BitsCorrected = bitsCorrected;
+	header.NCodes        = family->ncodes;
+	header.NBits         = family->nbits;
+	header.CodesHash     = hashCodes(family);
+	header.NEntries      = expectedEntries(family, bitsCorrected);
+	return header;
+}
+
+} // namespace details
+
+QuickDecodeTable::Ptr
+QuickDecodeTable::Build(apriltag_family_t *family, int bitsCorrected) {
+	auto start = Time::Now();
+	// apriltag only exposes the table construction through
+	// apriltag_detector_add_family_bits(), so we use a throw-away detector.
+	auto td = apriltag_detector_create();
+	apriltag_detector_add_family_bits(td, family, bitsCorrected);
+	Detach(td);
+	apriltag_detector_destroy(td);
+
+	slog::Info(
+	    "built quick decode table",
+	    slog::String("family", family->name),
+	    slog::Int("bits_corrected", bitsCorrected),
+	    slog::Float("duration_s", Time::Now().Sub(start).Seconds())
+	);
+
+	return Ptr{new QuickDecodeTable{family, bitsCorrected}};
+}
+
+std::filesystem::path QuickDecodeTable::CachePath(
+    const apriltag_family_t     *family,
+    int                          bitsCorrected,
+    const std::filesystem::path &cacheDir
+) {
+	return cacheDir / (std::string{family->name} + "." +
+	                   std::to_string(bitsCorrected) + "bits.qdt");
+}
+
+QuickDecodeTable::Ptr QuickDecodeTable::Load(
+    apriltag_family_t           *family,
+    int                          bitsCorrected,
+    const std::filesystem::path &cacheDir
+) {
+	auto path = CachePath(family, bitsCorrected, cacheDir);
+	if (auto res = map(family, bitsCorrected, path); res != nullptr) {
+		return res;
+	}
+
+	auto res = Build(family, bitsCorrected);
+	try {
+		res->save(path);
+	} catch (const std::exception &e) {
+		slog::Warn(
+		    "could not save quick decode table",
+		    slog::String("path", path.string()),
+		    slog::Err(e)
+		);
+	}
+	return res;
+}
+
+QuickDecodeTable::Ptr QuickDecodeTable::map(
+    apriltag_family_t *family, int bitsCorrected, const std::filesystem::path &path
+) {
+	auto logger = slog::With(slog::String("path", path.string()));
+	int  fd     = open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		logger.Info("no cached quick decode table");
+		return nullptr;
+	}
+	Defer {
+		close(fd);
+	};
+
+	const auto expected = details::makeHeader(family, bitsCorrected);
+	const size_t size   = sizeof(details::CacheHeader) +
+	                    expected.NEntries * sizeof(details::QuickDecodeEntry);
+
+	struct stat infos;
+	if (fstat(fd, &infos) != 0 || size_t(infos.st_size) != size) {
+		logger.Warn("invalid cached quick decode table size");
+		return nullptr;
+	}
+
+	void *mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	if (mapped == MAP_FAILED) {
+		logger.Warn("could not map cached quick decode table");
+		return nullptr;
+	}
+
+	if (memcmp(mapped, &expected, sizeof(details::CacheHeader)) != 0) {
+		logger.Warn("cached quick decode table does not match family");
+		munmap(mapped, size);
+		return nullptr;
+	}
+
+	// apriltag only reads the table, but its declaration is not const.
+	auto qd = new details::QuickDecode{
+	    .nentries = int(expected.NEntries),
+	    .entries  = reinterpret_cast<details::QuickDecodeEntry *>(
+            static_cast<uint8_t *>(mapped) + sizeof(details::CacheHeader)
+        ),
+	};
+	if (details::checkLayout(family, bitsCorrected, qd) == false) {
+		logger.Warn("cached quick decode table is corrupted");
+		delete qd;
+		munmap(mapped, size);
+		return nullptr;
+	}
+	family->impl = qd;
+
+	logger.Info(
+	    "mapped quick decode table",
+	    slog::String("family", family->name),
+	    slog::Int("bits_corrected", bitsCorrected),
+	    slog::Float("size_MB", size / 1024.0 / 1024.0)
+	);
+
+	auto res          = Ptr{new QuickDecodeTable{family, bitsCorrected}};
+	res->d_mapped     = mapped;
+	res->d_mappedSize = size;
+	return res;
+}
+
+void QuickDecodeTable::save(const std::filesystem::path &path) const {
+	const auto header = details::makeHeader(d_family, d_bitsCorrected);
+	const auto qd     = static_cast<details::QuickDecode *>(d_family->impl);
+	if (details::checkLayout(d_family, d_bitsCorrected, qd) == false) {
+		throw std::runtime_error(
+		    "unexpected apriltag quick decode layout, not caching it"
+		);
+	}
+
+	std::filesystem::create_directories(path.parent_path());
+	// other processes may map the file concurrently, so we atomically
+	// replace it.
+	auto tmpPath = path;
+	tmpPath += ".tmp." + std::to_string(getpid());
+	{
+		std::ofstream out{tmpPath, std::ios::binary | std::ios::trunc};
+		out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		out.write(
+		    reinterpret_cast<const char *>(qd->entries),
+		    header.NEntries * sizeof(details::QuickDecodeEntry)
+		);
+		if (out.good() == false) {
+			std::filesystem::remove(tmpPath);
+			throw std::runtime_error("could not write '" + tmpPath.string() + "'");
+		}
+	}
+	std::filesystem::rename(tmpPath, path);
+
+	slog::Info(
+	    "saved quick decode table",
+	    slog::String("path", path.string())
+	);
+}
+
+QuickDecodeTable::QuickDecodeTable(
+    apriltag_family_t *family, int bitsCorrected
+)
+    : d_family{family}
+    , d_bitsCorrected{bitsCorrected} {}
+
+QuickDecodeTable::~QuickDecodeTable() {
+	if (d_mapped != nullptr) {
+		delete static_cast<details::QuickDecode *>(d_family->impl);
+		d_family->impl = nullptr;
+		munmap(d_mapped, d_mappedSize);
+		return;
+	}
+	// apriltag_detector_clear_families() is the only public way to free the
+	// table.
+	auto td = apriltag_detector_create();
+	zarray_add(td->tag_families, &d_family);
+	apriltag_detector_destroy(td);
+}
+
+void QuickDecodeTable::Attach(apriltag_detector_t *detector) const {
+	zarray_add(detector->tag_families, &d_family);
+}
+
+void QuickDecodeTable::Detach(apriltag_detector_t *detector) {
+	zarray_clear(detector->tag_families);
+}
+
+int QuickDecodeTable::BitsCorrected() const {
+	return d_bitsCorrected;
+}
+
+bool QuickDecodeTable::IsMapped() const {
+	return d_mapped != nullptr;
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <apriltag/apriltag.h>
+
+#include <filesystem>
+#include <memory>
+
+namespace fort {
+namespace artemis {
+
+// Owns the quick decode table of an apriltag family. apriltag builds it in
+// family->impl when the family is first added to a detector, and frees it
+// when any detector using the family is destroyed. Here the table lives as
+// long as this object: detectors only attach and detach the family, and the
+// table can be mapped from a cache file instead of being built.
+class QuickDecodeTable {
+public:
+	typedef std::unique_ptr<QuickDecodeTable> Ptr;
+
+	static Ptr Build(apriltag_family_t *family, int bitsCorrected);
+
+	// Maps the table from a cache file in cacheDir. If the file is missing
+	// or does not match the family, the table is built and saved for the
+	// next start.
+	static Ptr Load(
+	    apriltag_family_t           *family,
+	    int                          bitsCorrected,
+	    const std::filesystem::path &cacheDir
+	);
+
+	static std::filesystem::path CachePath(
+	    const apriltag_family_t     *family,
+	    int                          bitsCorrected,
+	    const std::filesystem::path &cacheDir
+	);
+
+	~QuickDecodeTable();
+
+	QuickDecodeTable(const QuickDecodeTable &other)            = delete;
+	QuickDecodeTable(QuickDecodeTable &&other)                 = delete;
+	QuickDecodeTable &operator=(const QuickDecodeTable &other) = delete;
+	QuickDecodeTable &operator=(QuickDecodeTable &&other)      = delete;
+
+	// Registers the family in detector without building its table again.
+	void Attach(apriltag_detector_t *detector) const;
+
+	// Removes all families from detector. Must be called before
+	// apriltag_detector_destroy(), which would otherwise free the shared
+	// table.
+	static void Detach(apriltag_detector_t *detector);
+
+	int BitsCorrected() const;
+
+	bool IsMapped() const;
+
+private:
+	QuickDecodeTable(apriltag_family_t *family, int bitsCorrected);
+
+	static Ptr map(
+	    apriltag_family_t           *family,
+	    int                          bitsCorrected,
+	    const std::filesystem::path &path
+	);
+
+	void save(const std::filesystem::path &path) const;
+
+	apriltag_family_t *d_family;
+	int                d_bitsCorrected;
+	void              *d_mapped     = nullptr;
+	size_t             d_mappedSize = 0;
+};
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "QuickDecodeTable.hpp"
+
+#include <apriltag/tag16h5.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fort {
+namespace artemis {
+
+class QuickDecodeTableTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		d_family = tag16h5_create();
+		char tmpl[] = "/tmp/artemis-qdt-XXXXXX";
+		ASSERT_NE(mkdtemp(tmpl), nullptr);
+		d_cacheDir = tmpl;
+	}
+
+	void TearDown() override {
+		tag16h5_destroy(d_family);
+		std::filesystem::remove_all(d_cacheDir);
+	}
+
+	// Renders tag ID scaled 10 times on a white 200x200 image and returns
+	// the decoded IDs.
+	std::vector<int> detect(const QuickDecodeTable &table, uint32_t ID) {
+		auto tag = apriltag_to_image(d_family, ID);
+		auto img = image_u8_create(200, 200);
+		memset(img->buf, 255, img->stride * img->height);
+		for (int y = 0; y < 10 * tag->height; ++y) {
+			for (int x = 0; x < 10 * tag->width; ++x) {
+				img->buf[(y + 50) * img->stride + x + 50] =
+				    tag->buf[(y / 10) * tag->stride + x / 10];
+			}
+		}
+
+		auto td = apriltag_detector_create();
+		table.Attach(td);
+		auto detections = apriltag_detector_detect(td, img);
+		std::vector<int> res;
+		for (int i = 0; i < zarray_size(detections); ++i) {
+			apriltag_detection_t *d;
+			zarray_get(detections, i, &d);
+			res.push_back(d->id);
+		}
+		apriltag_detections_destroy(detections);
+		QuickDecodeTable::Detach(td);
+		apriltag_detector_destroy(td);
+		image_u8_destroy(img);
+		image_u8_destroy(tag);
+		return res;
+	}
+
+	apriltag_family_t    *d_family;
+	std::filesystem::path d_cacheDir;
+};
+
+TEST_F(QuickDecodeTableTest, IsPersisted) {
+	auto path = QuickDecodeTable::CachePath(d_family, 2, d_cacheDir);
+	{
+		auto table = QuickDecodeTable::Load(d_family, 2, d_cacheDir);
+		EXPECT_FALSE(table->IsMapped());
+		EXPECT_TRUE(std::filesystem::exists(path));
+		EXPECT_EQ(detect(*table, 12), std::vector<int>{12});
+	}
+	EXPECT_EQ(d_family->impl, nullptr);
+
+	auto table = QuickDecodeTable::Load(d_family, 2, d_cacheDir);
+	EXPECT_TRUE(table->IsMapped());
+	EXPECT_EQ(detect(*table, 12), std::vector<int>{12});
+	EXPECT_EQ(detect(*table, 27), std::vector<int>{27});
+}
+
+TEST_F(QuickDecodeTableTest, RejectsMismatchingCache) {
+	QuickDecodeTable::Load(d_family, 1, d_cacheDir);
+	// a table for another number of corrected bits must not be used.
+	std::filesystem::rename(
+	    QuickDecodeTable::CachePath(d_family, 1, d_cacheDir),
+	    QuickDecodeTable::CachePath(d_family, 2, d_cacheDir)
+	);
+	auto table = QuickDecodeTable::Load(d_family, 2, d_cacheDir);
+	EXPECT_FALSE(table->IsMapped());
+	EXPECT_EQ(detect(*table, 3), std::vector<int>{3});
+}
+
+TEST_F(QuickDecodeTableTest, RejectsCorruptedEntries) {
+	QuickDecodeTable::Load(d_family, 1, d_cacheDir);
+	auto path = QuickDecodeTable::CachePath(d_family, 1, d_cacheDir);
+	{
+		// same header and size, but every entry is empty.
+		std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+		file.seekp(4096);
+		std::vector<char> empty(
+		    std::filesystem::file_size(path) - 4096,
+		    char(0xff)
+		);
+		file.write(empty.data(), empty.size());
+		ASSERT_TRUE(file.good());
+	}
+	auto table = QuickDecodeTable::Load(d_family, 1, d_cacheDir);
+	EXPECT_FALSE(table->IsMapped());
+	EXPECT_EQ(detect(*table, 5), std::vector<int>{5});
+}
+
+} // namespace artemis
+} // namespace fort
@@ -6,6 +6,9 @@
 
 #include <unistd.h>
 
+#include <algorithm>
+#include <thread>
+
 namespace fort {
 namespace artemis {
 
@@ -13,6 +16,11 @@ StubFrame::StubFrame(const ImageU8 &image, uint64_t ID)
     : d_ID(ID)
     , d_image{image} {}
 
+StubFrame::StubFrame(ImageU8::OwnedPtr image, uint64_t ID)
+    : d_ID(ID)
+    , d_owned{std::move(image)}
+    , d_image{*d_owned} {}
+
 StubFrame::~StubFrame() {}
 
 void *StubFrame::Data() {
@@ -40,14 +48,25 @@ ImageU8 StubFrame::ToImageU8() {
 }
 
 StubFrameGrabber::StubFrameGrabber(
-    const std::vector<std::string> &paths, double FPS
+    const std::vector<std::string> &paths, double FPS, size_t prefetch
 )
-    : d_ID(0)
+    : d_paths(paths)
+    , d_ID(0)
     , d_timestamp(0)
-    , d_period(1.0e9 / FPS) {
+    , d_period(FPS > 0.0 ? 1.0e9 / FPS : 0.0)
+    , d_prefetch(prefetch) {
 	if (paths.empty() == true) {
 		throw std::invalid_argument("No paths given to StubFrameGrabber");
 	}
+	if (d_prefetch > 0) {
+		// only the first image is needed for the resolution, the others are
+		// decoded while running.
+		d_resolution       = load(0)->Size();
+		const size_t cores = std::max(std::thread::hardware_concurrency(), 1U);
+		d_decoder = std::make_unique<tf::Executor>(std::min(d_prefetch, cores));
+		return;
+	}
+
 	tf::Executor exec;
 	tf::Taskflow taskflow;
 
@@ -72,9 +91,23 @@ StubFrameGrabber::StubFrameGrabber(
 			);
 		}
 	}
+	d_resolution = d_images.front()->Size();
+}
+
+StubFrameGrabber::~StubFrameGrabber() {
+	// pending decodes may still use this object.
+	for (auto &f : d_decoding) {
+		f.wait();
+	}
 }
 
-StubFrameGrabber::~StubFrameGrabber() {}
+ImageU8::OwnedPtr StubFrameGrabber::load(size_t index) const {
+	auto res = ImageU8::ReadPNG(d_paths[index]);
+	if (res->buffer == NULL) {
+		throw std::runtime_error("Could not load '" + d_paths[index] + "'");
+	}
+	return res;
+}
 
 void StubFrameGrabber::Start() {
 	d_last = Time::Now().Add(-d_period);
@@ -83,7 +116,28 @@ void StubFrameGrabber::Start() {
 void StubFrameGrabber::Stop() {}
 
 Size StubFrameGrabber::Resolution() const {
-	return {d_images.front()->width, d_images.front()->height};
+	return d_resolution;
+}
+
+Frame::Ptr StubFrameGrabber::nextStreamed() {
+	// keeps the window full, so at most d_prefetch images are decoded ahead.
+	while (d_decoding.size() < d_prefetch) {
+		d_decoding.push_back(d_decoder->async(
+		    [this, index = d_nextDecoded++ % d_paths.size()]() {
+			    return load(index);
+		    }
+		));
+	}
+	const size_t index = d_ID % d_paths.size();
+	auto         image = d_decoding.front().get();
+	d_decoding.pop_front();
+	if (image->Size() != d_resolution) {
+		throw std::runtime_error(
+		    "'" + d_paths[0] + "' and '" + d_paths[index] +
+		    "' have different sizes"
+		);
+	}
+	return std::make_shared<StubFrame>(std::move(image), d_ID);
 }
 
 Frame::Ptr StubFrameGrabber::NextFrame() {
@@ -92,8 +146,15 @@ Frame::Ptr StubFrameGrabber::NextFrame() {
 		usleep(toWait.Microseconds());
 	}
 
-	Frame::Ptr res =
-	    std::make_shared<StubFrame>(*d_images[d_ID % d_images.size()], d_ID);
+	Frame::Ptr res;
+	if (d_prefetch > 0) {
+		res = nextStreamed();
+	} else {
+		res = std::make_shared<StubFrame>(
+		    *d_images[d_ID % d_images.size()],
+		    d_ID
+		);
+	}
 	d_ID += 1;
 	d_last = res->Time();
 	return res;
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <deque>
+#include <future>
+
+#include <taskflow/core/executor.hpp>
+
 #include "FrameGrabber.hpp"
 
 namespace fort {
@@ -8,6 +13,7 @@ namespace artemis {
 class StubFrame : public Frame {
 public:
 	StubFrame(const ImageU8 &image, uint64_t ID);
+	StubFrame(ImageU8::OwnedPtr image, uint64_t ID);
 	virtual ~StubFrame();
 
 	virtual void    *Data() override;
@@ -18,13 +24,20 @@ public:
 	ImageU8          ToImageU8() override;
 
 private:
-	uint64_t d_ID;
-	ImageU8  d_image;
+	uint64_t          d_ID;
+	ImageU8::OwnedPtr d_owned;
+	ImageU8           d_image;
 };
 
 class StubFrameGrabber : public FrameGrabber {
 public:
-	StubFrameGrabber(const std::vector<std::string> &paths, double FPS);
+	// Frames are delivered at FPS, or as fast as they are requested if FPS
+	// is not positive. If prefetch is zero, all images are decoded in memory
+	// at once, otherwise they are decoded while running, at most prefetch
+	// ahead.
+	StubFrameGrabber(
+	    const std::vector<std::string> &paths, double FPS, size_t prefetch = 0
+	);
 
 	virtual ~StubFrameGrabber();
 
@@ -39,10 +52,21 @@ public:
 private:
 	typedef std::chrono::high_resolution_clock clock;
 	typedef clock::time_point                  time;
-	std::vector<ImageU8::OwnedPtr>             d_images;
-	uint64_t                                   d_ID, d_timestamp;
-	Time                                       d_last;
-	Duration                                   d_period;
+
+	ImageU8::OwnedPtr load(size_t index) const;
+	Frame::Ptr        nextStreamed();
+
+	std::vector<std::string>       d_paths;
+	std::vector<ImageU8::OwnedPtr> d_images;
+	uint64_t                       d_ID, d_timestamp;
+	Time                           d_last;
+	Duration                       d_period;
+	Size                           d_resolution;
+
+	size_t                                     d_prefetch;
+	uint64_t                                   d_nextDecoded = 0;
+	std::deque<std::future<ImageU8::OwnedPtr>> d_decoding;
+	std::unique_ptr<tf::Executor>              d_decoder;
 };
 
 } // namespace artemis
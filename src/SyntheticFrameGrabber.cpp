@@ -0,0 +1,262 @@
+#include "SyntheticFrameGrabber.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+#include <unistd.h>
+
+#include "ApriltagDetector.hpp"
+#include "StubFrameGrabber.hpp"
+
+namespace fort {
+namespace artemis {
+
+namespace details {
+// splitmix64, a cheap and good enough generator for pixel noise.
+inline uint64_t NextRandom(uint64_t &state) {
+	uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+	z          = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z          = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+inline uint8_t AddNoise(int value, size_t amplitude, uint64_t &state) {
+	if (amplitude == 0) {
+		return value;
+	}
+	value += int(NextRandom(state) % (2 * amplitude + 1)) - int(amplitude);
+	return std::clamp(value, 0, 255);
+}
+
+// Folds x in [min,max], as if bouncing on the bounds.
+inline double Bounce(double x, double min, double max) {
+	const double length = max - min;
+	if (length <= 0.0) {
+		return min;
+	}
+	double t = std::fmod(x - min, 2 * length);
+	if (t < 0) {
+		t += 2 * length;
+	}
+	return min + (t < length ? t : 2 * length - t);
+}
+} // namespace details
+
+SyntheticFrameGrabber::SyntheticFrameGrabber(
+    const SyntheticOptions &options, double FPS
+)
+    : d_size{int(options.Width), int(options.Height)}
+    , d_blur{options.Blur}
+    , d_noise{options.Noise}
+    , d_seed{options.Seed}
+    , d_period(FPS > 0.0 ? 1.0e9 / FPS : 0.0) {
+	if (options.Tags == 0) {
+		throw std::invalid_argument("at least one synthetic tag is needed");
+	}
+	if (options.TagSize == 0) {
+		throw std::invalid_argument("synthetic tag size must be positive");
+	}
+	auto family  = ApriltagDetector::CreateFamily(options.Family());
+	d_tagWidth   = family->total_width;
+	d_moduleSize = double(options.TagSize) / double(d_tagWidth);
+
+	// each tag moves in its own cell, with room for its rotation and blur.
+	const size_t cols = std::ceil(
+	    std::sqrt(double(options.Tags * options.Width) / double(options.Height))
+	);
+	const size_t rows       = (options.Tags + cols - 1) / cols;
+	const double cellWidth  = double(options.Width) / cols;
+	const double cellHeight = double(options.Height) / rows;
+	const double radius = options.TagSize * M_SQRT1_2 + options.Blur + 1;
+	if (cellWidth < 2 * radius || cellHeight < 2 * radius) {
+		throw std::invalid_argument(
+		    std::to_string(options.Tags) + " tags of " +
+		    std::to_string(options.TagSize) + " pixels do not fit in " +
+		    std::to_string(options.Width) + "x" +
+		    std::to_string(options.Height)
+		);
+	}
+
+	std::mt19937_64                        rng{options.Seed};
+	std::uniform_real_distribution<double> unit{0.0, 1.0};
+	d_tags.reserve(options.Tags);
+	for (size_t i = 0; i < options.Tags; ++i) {
+		Tag tag;
+		tag.ID    = i % family->ncodes;
+		auto code = apriltag_to_image(family.get(), tag.ID);
+		tag.Pixels.resize(d_tagWidth * d_tagWidth);
+		for (size_t y = 0; y < d_tagWidth; ++y) {
+			memcpy(
+			    &tag.Pixels[y * d_tagWidth],
+			    &code->buf[y * code->stride],
+			    d_tagWidth
+			);
+		}
+		image_u8_destroy(code);
+
+		const size_t col = i % cols, row = i / cols;
+		tag.MinX         = col * cellWidth + radius;
+		tag.MaxX         = (col + 1) * cellWidth - radius;
+		tag.MinY         = row * cellHeight + radius;
+		tag.MaxY         = (row + 1) * cellHeight - radius;
+		tag.X0           = tag.MinX + unit(rng) * (tag.MaxX - tag.MinX);
+		tag.Y0           = tag.MinY + unit(rng) * (tag.MaxY - tag.MinY);
+		tag.Theta0       = unit(rng) * 2 * M_PI;
+
+		const double direction = unit(rng) * 2 * M_PI;
+		tag.VX                 = options.Speed * std::cos(direction);
+		tag.VY                 = options.Speed * std::sin(direction);
+		tag.VTheta             = (unit(rng) - 0.5) * 0.04;
+		d_tags.push_back(std::move(tag));
+	}
+
+	// the background noise is fixed, so frames only need a copy of it.
+	const size_t stride = (d_size.width() + 63) & ~63;
+	d_background.resize(stride * d_size.height());
+	uint64_t state = d_seed;
+	for (auto &p : d_background) {
+		p = details::AddNoise(BACKGROUND, d_noise, state);
+	}
+
+	if (options.TruthFile.empty() == false) {
+		d_truthFile.open(options.TruthFile);
+		if (d_truthFile.is_open() == false) {
+			throw std::runtime_error(
+			    "could not open '" + options.TruthFile + "'"
+			);
+		}
+	}
+}
+
+SyntheticFrameGrabber::~SyntheticFrameGrabber() {}
+
+void SyntheticFrameGrabber::Start() {
+	d_last = Time::Now().Add(-d_period);
+}
+
+void SyntheticFrameGrabber::Stop() {}
+
+Size SyntheticFrameGrabber::Resolution() const {
+	return d_size;
+}
+
+std::vector<SyntheticFrameGrabber::GroundTruth>
+SyntheticFrameGrabber::Truth(uint64_t frameID) const {
+	std::vector<GroundTruth> res;
+	res.reserve(d_tags.size());
+	const double t = frameID;
+	for (const auto &tag : d_tags) {
+		res.push_back({
+		    .ID    = tag.ID,
+		    .X     = details::Bounce(tag.X0 + tag.VX * t, tag.MinX, tag.MaxX),
+		    .Y     = details::Bounce(tag.Y0 + tag.VY * t, tag.MinY, tag.MaxY),
+		    .Theta = std::fmod(tag.Theta0 + tag.VTheta * t, 2 * M_PI),
+		});
+	}
+	return res;
+}
+
+void SyntheticFrameGrabber::render(
+    ImageU8           &image,
+    const Tag         &tag,
+    const GroundTruth &truth,
+    uint64_t           noiseSeed
+) const {
+	const double half = d_tagWidth * d_moduleSize * M_SQRT1_2 + d_blur + 1;
+	const int    x0   = std::max(int(std::floor(truth.X - half)), 0);
+	const int    y0   = std::max(int(std::floor(truth.Y - half)), 0);
+	const int    x1   = std::min(int(std::ceil(truth.X + half)), image.width);
+	const int    y1   = std::min(int(std::ceil(truth.Y + half)), image.height);
+	const int    width = x1 - x0, height = y1 - y0;
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+
+	// nearest neighbor sampling of the rotated code.
+	const double c = std::cos(truth.Theta), s = std::sin(truth.Theta);
+	const double center = d_tagWidth / 2.0;
+	std::vector<uint8_t> patch(width * height);
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			const double dx = x0 + x + 0.5 - truth.X;
+			const double dy = y0 + y + 0.5 - truth.Y;
+			const double u  = (c * dx + s * dy) / d_moduleSize + center;
+			const double v  = (-s * dx + c * dy) / d_moduleSize + center;
+			if (u >= 0 && u < d_tagWidth && v >= 0 && v < d_tagWidth) {
+				patch[y * width + x] =
+				    tag.Pixels[size_t(v) * d_tagWidth + size_t(u)];
+			} else {
+				patch[y * width + x] = BACKGROUND;
+			}
+		}
+	}
+
+	// separable box blur, clamped on the patch borders.
+	if (d_blur > 0) {
+		const int            r = d_blur;
+		std::vector<uint8_t> tmp(patch.size());
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				int sum = 0;
+				for (int k = -r; k <= r; ++k) {
+					sum += patch[y * width + std::clamp(x + k, 0, width - 1)];
+				}
+				tmp[y * width + x] = sum / (2 * r + 1);
+			}
+		}
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				int sum = 0;
+				for (int k = -r; k <= r; ++k) {
+					sum += tmp[std::clamp(y + k, 0, height - 1) * width + x];
+				}
+				patch[y * width + x] = sum / (2 * r + 1);
+			}
+		}
+	}
+
+	uint64_t state = noiseSeed;
+	for (int y = 0; y < height; ++y) {
+		uint8_t *row = image.buffer + (y0 + y) * image.stride + x0;
+		for (int x = 0; x < width; ++x) {
+			row[x] = details::AddNoise(patch[y * width + x], d_noise, state);
+		}
+	}
+}
+
+Frame::Ptr SyntheticFrameGrabber::NextFrame() {
+	auto toWait = d_last.Add(d_period).Sub(Time::Now());
+	if (toWait > 0) {
+		usleep(toWait.Microseconds());
+	}
+
+	const size_t stride = (d_size.width() + 63) & ~63;
+	auto         buffer =
+	    static_cast<uint8_t *>(aligned_alloc(64, d_background.size()));
+	memcpy(buffer, d_background.data(), d_background.size());
+	auto image = ImageU8::OwnedPtr{new ImageU8{
+	    d_size.width(),
+	    d_size.height(),
+	    buffer,
+	    int32_t(stride),
+	}};
+
+	const auto truth = Truth(d_ID);
+	for (size_t i = 0; i < d_tags.size(); ++i) {
+		render(*image, d_tags[i], truth[i], d_seed ^ (d_ID << 20) ^ i);
+		if (d_truthFile.is_open()) {
+			d_truthFile << d_ID << " " << truth[i].ID << " " << truth[i].X
+			            << " " << truth[i].Y << " " << truth[i].Theta << "\n";
+		}
+	}
+
+	Frame::Ptr res = std::make_shared<StubFrame>(std::move(image), d_ID);
+	d_ID += 1;
+	d_last = res->Time();
+	return res;
+}
+
+} // namespace artemis
+} // namespace fort
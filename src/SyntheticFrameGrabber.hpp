@@ -0,0 +1,74 @@
+#pragma once
+
+#include <fstream>
+#include <vector>
+
+#include "FrameGrabber.hpp"
+#include "Options.hpp"
+
+namespace fort {
+namespace artemis {
+
+// Renders moving tags on a noisy background, for benchmarks without
+// hardware. Each tag moves in its own cell of a grid, so tags never overlap,
+// and bounces on the cell borders. Positions only depend on the frame ID and
+// the seed, so runs are reproducible and the ground truth is known.
+class SyntheticFrameGrabber : public FrameGrabber {
+public:
+	constexpr static uint8_t BACKGROUND = 160;
+
+	struct GroundTruth {
+		uint32_t ID;
+		// center of the tag, and rotation of the tag in radians.
+		double X, Y, Theta;
+	};
+
+	// Frames are delivered at FPS, or as fast as they are requested if FPS
+	// is not positive.
+	SyntheticFrameGrabber(const SyntheticOptions &options, double FPS);
+
+	virtual ~SyntheticFrameGrabber();
+
+	void       Start() override;
+	void       Stop() override;
+	Frame::Ptr NextFrame() override;
+
+	void AbordPending() override {}
+
+	Size Resolution() const override;
+
+	std::vector<GroundTruth> Truth(uint64_t frameID) const;
+
+private:
+	struct Tag {
+		uint32_t             ID;
+		std::vector<uint8_t> Pixels;
+		// motion bounds of the center, initial position and speed.
+		double MinX, MaxX, MinY, MaxY;
+		double X0, Y0, Theta0;
+		double VX, VY, VTheta;
+	};
+
+	void render(
+	    ImageU8           &image,
+	    const Tag         &tag,
+	    const GroundTruth &truth,
+	    uint64_t           noiseSeed
+	) const;
+
+	Size                 d_size;
+	size_t               d_tagWidth;
+	double               d_moduleSize;
+	size_t               d_blur, d_noise;
+	uint64_t             d_seed;
+	std::vector<Tag>     d_tags;
+	std::vector<uint8_t> d_background;
+	std::ofstream        d_truthFile;
+
+	uint64_t d_ID = 0;
+	Time     d_last;
+	Duration d_period;
+};
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "ApriltagDetector.hpp"
+#include "SyntheticFrameGrabber.hpp"
+
+namespace fort {
+namespace artemis {
+
+class SyntheticFrameGrabberTest : public ::testing::Test {
+protected:
+	void SetUp() {
+		d_options.Tags    = 4;
+		d_options.Width   = 640;
+		d_options.Height  = 480;
+		d_options.TagSize = 60;
+		d_options.Speed   = 5.0;
+		d_options.Seed    = 42;
+	}
+
+	SyntheticOptions d_options;
+};
+
+TEST_F(SyntheticFrameGrabberTest, TruthIsReproducibleAndInsideFrame) {
+	SyntheticFrameGrabber a{d_options, 0.0}, b{d_options, 0.0};
+	const double          radius = d_options.TagSize * M_SQRT1_2;
+	for (uint64_t frameID = 0; frameID < 1000; frameID += 7) {
+		auto truth = a.Truth(frameID);
+		auto other = b.Truth(frameID);
+		ASSERT_EQ(truth.size(), d_options.Tags);
+		ASSERT_EQ(other.size(), d_options.Tags);
+		for (size_t i = 0; i < truth.size(); ++i) {
+			EXPECT_EQ(truth[i].ID, i);
+			EXPECT_DOUBLE_EQ(truth[i].X, other[i].X);
+			EXPECT_DOUBLE_EQ(truth[i].Y, other[i].Y);
+			EXPECT_GE(truth[i].X, radius);
+			EXPECT_LE(truth[i].X, d_options.Width - radius);
+			EXPECT_GE(truth[i].Y, radius);
+			EXPECT_LE(truth[i].Y, d_options.Height - radius);
+		}
+	}
+
+	// tags move.
+	EXPECT_NE(a.Truth(0)[0].X, a.Truth(1)[0].X);
+}
+
+TEST_F(SyntheticFrameGrabberTest, RendersDetectableTags) {
+	SyntheticFrameGrabber grabber{d_options, 0.0};
+	ApriltagOptions       apriltag;
+	apriltag.family        = "36h11";
+	apriltag.NoDecodeCache = true;
+	ApriltagDetector detector{1, grabber.Resolution(), apriltag};
+	tf::Executor     executor{1};
+
+	grabber.Start();
+	for (size_t i = 0; i < 3; ++i) {
+		auto                 frame = grabber.NextFrame();
+		hermes::FrameReadout readout;
+		detector.SetInputOutput(frame->ToImageU8(), &readout);
+		executor.run(detector.Taskflow()).wait();
+
+		for (const auto &truth : grabber.Truth(frame->ID())) {
+			bool found = false;
+			for (const auto &tag : readout.tags()) {
+				if (tag.id() == truth.ID &&
+				    std::hypot(tag.x() - truth.X, tag.y() - truth.Y) < 1.5) {
+					found = true;
+				}
+			}
+			EXPECT_TRUE(found) << "tag " << truth.ID << " at (" << truth.X
+			                   << "," << truth.Y << ") in frame "
+			                   << frame->ID();
+		}
+	}
+}
+
+TEST_F(SyntheticFrameGrabberTest, ChecksConfig) {
+	d_options.Tags = 0;
+	EXPECT_THROW(SyntheticFrameGrabber(d_options, 0.0), std::invalid_argument);
+	d_options.Tags = 400;
+	EXPECT_THROW(SyntheticFrameGrabber(d_options, 0.0), std::invalid_argument);
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,126 @@
+#include "TagTracker.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace fort {
+namespace artemis {
+
+TagTracker::TagTracker(const Size &frameSize, size_t sweepPeriod, int window)
+    : d_frameSize{frameSize}
+    , d_sweepPeriod{sweepPeriod}
+    , d_window{std::min({window, frameSize.width(), frameSize.height()})} {}
+
+Eigen::Vector2d TagTracker::predict(const Track &t, uint64_t frameID) const {
+	double elapsed = double(frameID) - double(t.FrameID);
+	return {t.X + t.VX * elapsed, t.Y + t.VY * elapsed};
+}
+
+bool TagTracker::Plan(uint64_t frameID, Partition &rois, bool postponeSweep) {
+	rois.clear();
+	d_sweeping = d_sweepPeriod <= 1 || d_sinceSweep == 0 ||
+	             (d_sinceSweep >= d_sweepPeriod && postponeSweep == false);
+	if (d_sweeping) {
+		return true;
+	}
+
+	rois.reserve(d_tracks.size());
+	for (const auto &t : d_tracks) {
+		auto p = predict(t, frameID);
+		rois.push_back(GetROICenteredAt(
+		    {int(p.x()), int(p.y())},
+		    {d_window, d_window},
+		    d_frameSize
+		));
+	}
+	MergeOverlapping(rois);
+	return false;
+}
+
+void TagTracker::Update(const hermes::FrameReadout &readout) {
+	d_sinceSweep = d_sweeping ? 1 : d_sinceSweep + 1;
+
+	const uint64_t frameID = readout.frameid();
+
+	std::sort(
+	    d_tracks.begin(),
+	    d_tracks.end(),
+	    [](const Track &a, const Track &b) { return a.ID < b.ID; }
+	);
+	for (auto &t : d_tracks) {
+		t.Matched = false;
+	}
+
+	const double maxDistanceSquared = double(d_window) * double(d_window);
+	const size_t previousTracks     = d_tracks.size();
+
+	for (const auto &tag : readout.tags()) {
+		// the same ID may be present more than once, we match the closest
+		// unmatched track.
+		auto begin = std::lower_bound(
+		    d_tracks.begin(),
+		    d_tracks.begin() + previousTracks,
+		    tag.id(),
+		    [](const Track &t, uint32_t ID) { return t.ID < ID; }
+		);
+
+		Track *best         = nullptr;
+		double bestDistance = std::numeric_limits<double>::max();
+		for (auto it = begin;
+		     it != d_tracks.begin() + previousTracks && it->ID == tag.id();
+		     ++it) {
+			if (it->Matched) {
+				continue;
+			}
+			double distance = (predict(*it, frameID) -
+			                   Eigen::Vector2d{tag.x(), tag.y()})
+			                      .squaredNorm();
+			if (distance < bestDistance && distance <= maxDistanceSquared) {
+				best         = &(*it);
+				bestDistance = distance;
+			}
+		}
+
+		if (best == nullptr) {
+			d_tracks.push_back(Track{
+			    .ID      = tag.id(),
+			    .X       = tag.x(),
+			    .Y       = tag.y(),
+			    .VX      = 0.0,
+			    .VY      = 0.0,
+			    .FrameID = frameID,
+			    .Matched = true,
+			});
+			continue;
+		}
+
+		double elapsed = double(frameID) - double(best->FrameID);
+		if (elapsed > 0) {
+			best->VX = (tag.x() - best->X) / elapsed;
+			best->VY = (tag.y() - best->Y) / elapsed;
+		}
+		best->X       = tag.x();
+		best->Y       = tag.y();
+		best->FrameID = frameID;
+		best->Matched = true;
+	}
+
+	// A full sweep is authoritative, otherwise we keep lost tracks until the
+	// next sweep, as their windows may have been too small for this frame.
+	const bool sweeping = d_sweeping;
+	d_tracks.erase(
+	    std::remove_if(
+	        d_tracks.begin(),
+	        d_tracks.end(),
+	        [sweeping](const Track &t) { return sweeping && !t.Matched; }
+	    ),
+	    d_tracks.end()
+	);
+}
+
+size_t TagTracker::TrackCount() const {
+	return d_tracks.size();
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <fort/hermes/FrameReadout.pb.h>
+
+#include "Rect.hpp"
+#include "utils/Partitions.hpp"
+
+namespace fort {
+namespace artemis {
+
+// Follows the tags of previous readouts to restrict detection to windows
+// around their predicted position. A full frame sweep is requested every
+// sweepPeriod frames to pick up new tags.
+class TagTracker {
+public:
+	TagTracker(const Size &frameSize, size_t sweepPeriod, int window);
+
+	// Computes the windows to process for frameID. Returns true if the full
+	// frame should be processed instead, in which case rois is left empty. If
+	// postponeSweep is true, a due sweep is delayed to a later frame, unless
+	// no frame was swept yet.
+	bool Plan(uint64_t frameID, Partition &rois, bool postponeSweep = false);
+
+	// Updates the tracks with the result of the last planned frame.
+	void Update(const hermes::FrameReadout &readout);
+
+	size_t TrackCount() const;
+
+private:
+	struct Track {
+		uint32_t ID;
+		double   X, Y, VX, VY;
+		uint64_t FrameID;
+		bool     Matched;
+	};
+
+	Eigen::Vector2d predict(const Track &t, uint64_t frameID) const;
+
+	const Size   d_frameSize;
+	const size_t d_sweepPeriod;
+	const int    d_window;
+
+	std::vector<Track> d_tracks;
+	size_t             d_sinceSweep = 0;
+	bool               d_sweeping   = true;
+};
+
+} // namespace artemis
+} // namespace fort
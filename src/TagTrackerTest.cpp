@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include "TagTracker.hpp"
+
+namespace fort {
+namespace artemis {
+
+class TagTrackerTest : public ::testing::Test {
+protected:
+	static hermes::FrameReadout readout(
+	    uint64_t                                                 frameID,
+	    const std::vector<std::tuple<uint32_t, double, double>> &tags
+	) {
+		hermes::FrameReadout m;
+		m.set_frameid(frameID);
+		for (const auto &[ID, x, y] : tags) {
+			auto t = m.add_tags();
+			t->set_id(ID);
+			t->set_x(x);
+			t->set_y(y);
+		}
+		return m;
+	}
+};
+
+TEST_F(TagTrackerTest, SweepsPeriodically) {
+	TagTracker tracker{{1000, 1000}, 3, 100};
+	Partition  rois;
+	for (uint64_t frameID = 0; frameID < 7; ++frameID) {
+		bool expected = frameID % 3 == 0;
+		EXPECT_EQ(tracker.Plan(frameID, rois), expected)
+		    << "for frame " << frameID;
+		tracker.Update(readout(frameID, {}));
+	}
+
+	TagTracker always{{1000, 1000}, 1, 100};
+	for (uint64_t frameID = 0; frameID < 3; ++frameID) {
+		EXPECT_TRUE(always.Plan(frameID, rois));
+		always.Update(readout(frameID, {}));
+	}
+}
+
+TEST_F(TagTrackerTest, PostponesSweep) {
+	TagTracker tracker{{1000, 1000}, 3, 100};
+	Partition  rois;
+	// the first frame is always swept.
+	EXPECT_TRUE(tracker.Plan(0, rois, true));
+	tracker.Update(readout(0, {{1, 500, 500}}));
+	for (uint64_t frameID = 1; frameID < 6; ++frameID) {
+		EXPECT_FALSE(tracker.Plan(frameID, rois, true))
+		    << "for frame " << frameID;
+		EXPECT_EQ(rois.size(), 1);
+		tracker.Update(readout(frameID, {{1, 500, 500}}));
+	}
+	// the sweep is done as soon as it is not postponed anymore.
+	EXPECT_TRUE(tracker.Plan(6, rois));
+}
+
+TEST_F(TagTrackerTest, PredictsWindows) {
+	TagTracker tracker{{1000, 1000}, 10, 100};
+	Partition  rois;
+	EXPECT_TRUE(tracker.Plan(0, rois));
+	tracker.Update(readout(0, {{1, 500, 500}, {2, 10, 10}, {3, 550, 520}}));
+	EXPECT_EQ(tracker.TrackCount(), 3);
+
+	EXPECT_FALSE(tracker.Plan(1, rois));
+	ASSERT_EQ(rois.size(), 2);
+	EXPECT_EQ(rois[0], Rect({450, 450}, {150, 120}));
+	EXPECT_EQ(rois[1], Rect({0, 0}, {100, 100}));
+
+	// tag 1 moves by 10 pixels per frame, tag 2 is lost, tag 3 is static.
+	tracker.Update(readout(1, {{1, 510, 500}, {3, 550, 520}}));
+	EXPECT_EQ(tracker.TrackCount(), 3);
+	EXPECT_FALSE(tracker.Plan(3, rois));
+	ASSERT_EQ(rois.size(), 2);
+	EXPECT_EQ(rois[0], Rect({480, 450}, {120, 120}));
+	EXPECT_EQ(rois[1], Rect({0, 0}, {100, 100}));
+}
+
+TEST_F(TagTrackerTest, SweepDropsLostTracks) {
+	TagTracker tracker{{1000, 1000}, 2, 100};
+	Partition  rois;
+	EXPECT_TRUE(tracker.Plan(0, rois));
+	tracker.Update(readout(0, {{1, 500, 500}, {2, 10, 10}}));
+	EXPECT_FALSE(tracker.Plan(1, rois));
+	tracker.Update(readout(1, {{1, 500, 500}}));
+	EXPECT_EQ(tracker.TrackCount(), 2);
+	EXPECT_TRUE(tracker.Plan(2, rois));
+	EXPECT_TRUE(rois.empty());
+	tracker.Update(readout(2, {{1, 500, 500}}));
+	EXPECT_EQ(tracker.TrackCount(), 1);
+}
+
+} // namespace artemis
+} // namespace fort
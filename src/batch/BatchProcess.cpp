@@ -0,0 +1,141 @@
+#include "BatchProcess.hpp"
+
+#include <thread>
+
+#include <slog++/slog++.hpp>
+
+#include "ApriltagDetector.hpp"
+
+namespace fort {
+namespace artemis {
+
+double BatchProcess::Stats::FPS() const {
+	if (Elapsed.Seconds() <= 0.0) {
+		return 0.0;
+	}
+	return Frames / Elapsed.Seconds();
+}
+
+void BatchProcess::Execute(int argc, char **argv) {
+	BatchOptions options;
+	options.SetDescription(
+	    "reprocess archived frames offline and write their readouts to files"
+	);
+	options.ParseArguments(argc, (const char **)argv);
+	options.Validate();
+
+	BatchProcess process{options};
+	auto         stats = process.Run();
+	slog::Info(
+	    "batch done",
+	    slog::Int("frames", stats.Frames),
+	    slog::Int("tags", stats.Tags),
+	    slog::Float("elapsed_s", stats.Elapsed.Seconds()),
+	    slog::Float("fps", stats.FPS())
+	);
+}
+
+BatchProcess::BatchProcess(const BatchOptions &options)
+    : d_UUID{options.UUID}
+    , d_source{FrameSource::Open(options.Input, options.FPS)}
+    , d_writer{std::make_unique<ReadoutWriter>(
+          options.Output, options.SegmentSize
+      )}
+    , d_logger{slog::With(slog::String("task", "BatchProcess"))} {
+	// each detector processes its own frames with its share of the threads.
+	const size_t threads = std::max(
+	    d_executor.num_workers() / options.ParallelFrames,
+	    size_t(1)
+	);
+	for (size_t i = 0; i < options.ParallelFrames; ++i) {
+		d_detectors.push_back(std::make_unique<ApriltagDetector>(
+		    threads,
+		    d_source->Resolution(),
+		    options.Apriltag
+		));
+	}
+	d_lines.resize(options.ParallelFrames);
+
+	d_logger.Info(
+	    "processing",
+	    slog::String("input", options.Input),
+	    slog::Int("width", d_source->Resolution().width()),
+	    slog::Int("height", d_source->Resolution().height()),
+	    slog::Int("parallel_frames", options.ParallelFrames),
+	    slog::Int("threads_per_frame", threads)
+	);
+}
+
+BatchProcess::~BatchProcess() {}
+
+void BatchProcess::read(Line &line, tf::Pipeflow &pf) {
+	line.Frame = d_source->Next();
+	if (line.Frame == nullptr) {
+		pf.stop();
+		return;
+	}
+	auto &m = line.Readout;
+	m.Clear();
+	m.set_timestamp(line.Frame->Timestamp());
+	m.set_frameid(line.Frame->ID());
+	m.set_producer_uuid(d_UUID);
+	m.set_width(line.Frame->Width());
+	m.set_height(line.Frame->Height());
+}
+
+void BatchProcess::detect(Line &line, ApriltagDetector &detector) {
+	detector.SetInputOutput(line.Frame->ToImageU8(), &line.Readout);
+	d_executor.corun(detector.Taskflow());
+}
+
+void BatchProcess::write(Line &line) {
+	d_writer->Write(line.Readout);
+	d_stats.Tags += line.Readout.tags_size();
+	line.Frame.reset();
+
+	if (++d_stats.Frames % PROGRESS_PERIOD != 0) {
+		return;
+	}
+	d_stats.Elapsed = Time::Now().Sub(d_start);
+	d_logger.Info(
+	    "progress",
+	    slog::Int("frames", d_stats.Frames),
+	    slog::Float("fps", d_stats.FPS())
+	);
+}
+
+BatchProcess::Stats BatchProcess::Run() {
+	d_stats = Stats{};
+	d_start = Time::Now();
+
+	// the reading and writing pipes are serial, so frames are decoded and
+	// written in order, while up to one frame per line is detected.
+	tf::Pipeline pipeline{
+	    d_lines.size(),
+	    tf::Pipe{
+	        tf::PipeType::SERIAL,
+	        [this](tf::Pipeflow &pf) { read(d_lines[pf.line()], pf); }
+	    },
+	    tf::Pipe{
+	        tf::PipeType::PARALLEL,
+	        [this](tf::Pipeflow &pf) {
+		        detect(d_lines[pf.line()], *d_detectors[pf.line()]);
+	        }
+	    },
+	    tf::Pipe{
+	        tf::PipeType::SERIAL,
+	        [this](tf::Pipeflow &pf) { write(d_lines[pf.line()]); }
+	    },
+	};
+
+	tf::Taskflow taskflow;
+	taskflow.composed_of(pipeline).name("batch");
+	d_executor.run(taskflow).get();
+	d_writer->Close();
+
+	d_stats.Elapsed = Time::Now().Sub(d_start);
+	return d_stats;
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <taskflow/algorithm/pipeline.hpp>
+#include <taskflow/taskflow.hpp>
+
+#include <slog++/Logger.hpp>
+
+#include <fort/hermes/FrameReadout.pb.h>
+#include <fort/time/Time.hpp>
+
+#include "FrameGrabber.hpp"
+#include "Options.hpp"
+
+#include "FrameSource.hpp"
+#include "ReadoutWriter.hpp"
+
+namespace fort {
+namespace artemis {
+
+class ApriltagDetector;
+typedef std::unique_ptr<ApriltagDetector> ApriltagDetectorPtr;
+
+// Reprocesses archived frames as fast as possible. Frames are decoded in
+// order, detected in parallel by several detectors, and their readouts are
+// written in order.
+class BatchProcess {
+public:
+	constexpr static size_t PROGRESS_PERIOD = 1000;
+
+	struct Stats {
+		size_t   Frames = 0, Tags = 0;
+		Duration Elapsed;
+
+		double FPS() const;
+	};
+
+	static void Execute(int argc, char **argv);
+
+	BatchProcess(const BatchOptions &options);
+	~BatchProcess();
+
+	Stats Run();
+
+private:
+	// a frame in flight, one per pipeline line.
+	struct Line {
+		artemis::Frame::Ptr  Frame;
+		hermes::FrameReadout Readout;
+	};
+
+	void read(Line &line, tf::Pipeflow &pf);
+	void detect(Line &line, ApriltagDetector &detector);
+	void write(Line &line);
+
+	std::string                      d_UUID;
+	FrameSource::Ptr                 d_source;
+	std::unique_ptr<ReadoutWriter>   d_writer;
+	std::vector<ApriltagDetectorPtr> d_detectors;
+	std::vector<Line>                d_lines;
+	Stats                            d_stats;
+	Time                             d_start;
+	tf::Executor                     d_executor;
+	slog::Logger<1>                  d_logger;
+};
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,395 @@
+#include "FrameSource.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <regex>
+#include <sstream>
+
+#include <gst/app/gstappsink.h>
+
+#include <cpptrace/cpptrace.hpp>
+
+#include <fort/utils/Defer.hpp>
+
+namespace fort {
+namespace artemis {
+
+DecodedFrame::DecodedFrame(
+    ImageU8::OwnedPtr image, uint64_t ID, uint64_t timestamp
+)
+    : d_image{std::move(image)}
+    , d_ID{ID}
+    , d_timestamp{timestamp} {}
+
+DecodedFrame::~DecodedFrame() {}
+
+void *DecodedFrame::Data() {
+	return d_image->buffer;
+}
+
+size_t DecodedFrame::Width() const {
+	return d_image->width;
+}
+
+size_t DecodedFrame::Height() const {
+	return d_image->height;
+}
+
+uint64_t DecodedFrame::Timestamp() const {
+	return d_timestamp;
+}
+
+uint64_t DecodedFrame::ID() const {
+	return d_ID;
+}
+
+ImageU8 DecodedFrame::ToImageU8() {
+	return ImageU8{*d_image};
+}
+
+FrameSource::~FrameSource() {}
+
+FrameSource::Ptr
+FrameSource::Open(const std::filesystem::path &path, double FPS) {
+	if (FPS <= 0.0) {
+		throw std::invalid_argument("FPS must be positive");
+	}
+	if (std::filesystem::is_directory(path) == false) {
+		throw std::invalid_argument(
+		    "'" + path.string() + "' is not a directory"
+		);
+	}
+
+	auto segments = VideoSegmentSource::ListSegments(path);
+	if (segments.empty() == false) {
+		return std::make_unique<VideoSegmentSource>(std::move(segments), FPS);
+	}
+
+	std::vector<std::filesystem::path> images;
+	for (const auto &entry : std::filesystem::directory_iterator(path)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".png") {
+			images.push_back(entry.path());
+		}
+	}
+	if (images.empty()) {
+		throw std::invalid_argument(
+		    "'" + path.string() + "' contains no video segments or PNG files"
+		);
+	}
+	std::sort(images.begin(), images.end());
+	return std::make_unique<PNGSequenceSource>(std::move(images), FPS);
+}
+
+PNGSequenceSource::PNGSequenceSource(
+    std::vector<std::filesystem::path> paths, double FPS
+)
+    : d_paths{std::move(paths)}
+    , d_period{int64_t(1.0e9 / FPS)} {
+	if (d_paths.empty()) {
+		throw std::invalid_argument("No paths given to PNGSequenceSource");
+	}
+	// the first frame gives the resolution.
+	auto first   = ImageU8::ReadPNG(d_paths.front());
+	d_resolution = first->Size();
+}
+
+PNGSequenceSource::~PNGSequenceSource() {}
+
+Frame::Ptr PNGSequenceSource::Next() {
+	if (d_next >= d_paths.size()) {
+		return nullptr;
+	}
+	const size_t index = d_next++;
+	auto         image = ImageU8::ReadPNG(d_paths[index]);
+	if (image->Size() != d_resolution) {
+		throw cpptrace::runtime_error(
+		    "'" + d_paths[index].string() + "' and '" + d_paths[0].string() +
+		    "' have different sizes"
+		);
+	}
+	return std::make_shared<DecodedFrame>(
+	    std::move(image),
+	    index,
+	    uint64_t(index * d_period.Microseconds())
+	);
+}
+
+Size PNGSequenceSource::Resolution() const {
+	return d_resolution;
+}
+
+std::map<uint64_t, uint64_t>
+VideoSegmentSource::ReadFrameMatching(const std::filesystem::path &path) {
+	std::ifstream in{path};
+	if (in.is_open() == false) {
+		throw cpptrace::runtime_error(
+		    "could not open frame matching file '" + path.string() + "'"
+		);
+	}
+	std::map<uint64_t, uint64_t> res;
+	std::string                  line;
+	size_t                       lineNumber = 0;
+	while (std::getline(in, line)) {
+		++lineNumber;
+		if (line.empty()) {
+			continue;
+		}
+		std::istringstream iss{line};
+		uint64_t           stream, global;
+		if (!(iss >> stream >> global)) {
+			throw cpptrace::runtime_error(
+			    "invalid frame matching at '" + path.string() + "':" +
+			    std::to_string(lineNumber) + ": '" + line + "'"
+			);
+		}
+		res[stream] = global;
+	}
+	return res;
+}
+
+std::vector<VideoSegmentSource::Segment>
+VideoSegmentSource::ListSegments(const std::filesystem::path &dir) {
+	static std::regex segmentName{R"(stream\.(\d{4})\.mp4)"};
+
+	std::vector<Segment> res;
+	for (const auto &entry : std::filesystem::directory_iterator(dir)) {
+		std::smatch match;
+		const auto  filename = entry.path().filename().string();
+		if (entry.is_regular_file() == false ||
+		    std::regex_match(filename, match, segmentName) == false) {
+			continue;
+		}
+		auto matching =
+		    dir / ("stream.frame-matching." + match[1].str() + ".txt");
+		if (std::filesystem::exists(matching) == false) {
+			throw cpptrace::runtime_error(
+			    "missing frame matching file '" + matching.string() + "'"
+			);
+		}
+		res.push_back({.Video = entry.path(), .FrameMatching = matching});
+	}
+	std::sort(res.begin(), res.end(), [](const Segment &a, const Segment &b) {
+		return a.Video < b.Video;
+	});
+	return res;
+}
+
+VideoSegmentSource::VideoSegmentSource(
+    std::vector<Segment> segments, double FPS
+)
+    : d_segments{std::move(segments)}
+    , d_period{int64_t(1.0e9 / FPS)}
+    , d_logger{slog::With(slog::String("task", "VideoSegmentSource"))} {
+	if (d_segments.empty()) {
+		throw std::invalid_argument("No segments given to VideoSegmentSource");
+	}
+	// the first frame gives the resolution.
+	d_pending = pullFrame();
+	if (d_pending == nullptr) {
+		throw cpptrace::runtime_error(
+		    "no frames could be decoded from '" +
+		    d_segments.front().Video.string() + "'"
+		);
+	}
+	d_resolution = d_pending->Size();
+}
+
+VideoSegmentSource::~VideoSegmentSource() {
+	closeSegment();
+}
+
+bool VideoSegmentSource::openNextSegment() {
+	closeSegment();
+	if (d_segment >= d_segments.size()) {
+		return false;
+	}
+	const auto &segment = d_segments[d_segment++];
+	d_frameMatching     = ReadFrameMatching(segment.FrameMatching);
+	d_streamID          = 0;
+
+	EnsureGSTInitialized();
+	// the sink is not synchronized on the clock, so frames are decoded as
+	// fast as possible.
+	const std::string description =
+	    "filesrc location=\"" + segment.Video.string() +
+	    "\" ! decodebin ! videoconvert ! video/x-raw,format=GRAY8 ! appsink "
+	    "name=sink sync=false max-buffers=4";
+	GError *error = nullptr;
+	Defer {
+		if (error != nullptr) {
+			g_error_free(error);
+		}
+	};
+	d_pipeline = GstElementPtr{gst_parse_launch(description.c_str(), &error)};
+	if (d_pipeline == nullptr || error != nullptr) {
+		throw cpptrace::runtime_error(
+		    "could not create decoding pipeline for '" +
+		    segment.Video.string() + "': " +
+		    std::string{error == nullptr ? "unknown error" : error->message}
+		);
+	}
+	d_sink = gst_bin_get_by_name(GST_BIN(d_pipeline.get()), "sink");
+	gst_element_set_state(d_pipeline.get(), GST_STATE_PLAYING);
+
+	d_logger.Info(
+	    "decoding segment",
+	    slog::String("path", segment.Video.string()),
+	    slog::Int("frames", d_frameMatching.size())
+	);
+	return true;
+}
+
+void VideoSegmentSource::closeSegment() {
+	if (d_pipeline == nullptr) {
+		return;
+	}
+	gst_element_set_state(d_pipeline.get(), GST_STATE_NULL);
+	if (d_sink != nullptr) {
+		gst_object_unref(d_sink);
+		d_sink = nullptr;
+	}
+	d_pipeline.reset();
+}
+
+bool VideoSegmentSource::segmentEnded() {
+	const auto &path = d_segments[d_segment - 1].Video;
+
+	GstBusPtr   bus{gst_element_get_bus(d_pipeline.get())};
+	GstMessage *message = gst_bus_pop_filtered(bus.get(), GST_MESSAGE_ERROR);
+	if (message == nullptr &&
+	    gst_app_sink_is_eos(GST_APP_SINK(d_sink)) == false) {
+		return false;
+	}
+	// a truncated segment, e.g. after a crash, should not stop the
+	// processing of the following ones.
+	if (message != nullptr) {
+		GError *error = nullptr;
+		gchar  *debug = nullptr;
+		gst_message_parse_error(message, &error, &debug);
+		Defer {
+			if (error != nullptr) {
+				g_error_free(error);
+			}
+			g_free(debug);
+			gst_message_unref(message);
+		};
+		d_logger.Warn(
+		    "could not decode segment",
+		    slog::String("path", path.string()),
+		    slog::String(
+		        "error",
+		        error == nullptr ? "unknown error" : error->message
+		    ),
+		    slog::String("debug_info", debug == nullptr ? "" : debug)
+		);
+	}
+
+	if (d_streamID < d_frameMatching.size()) {
+		d_logger.Warn(
+		    "missing frames in segment",
+		    slog::String("path", path.string()),
+		    slog::Int("decoded", d_streamID),
+		    slog::Int("expected", d_frameMatching.size())
+		);
+	}
+	return true;
+}
+
+ImageU8::OwnedPtr VideoSegmentSource::pullImage() {
+	if (d_sink == nullptr) {
+		return nullptr;
+	}
+	// on errors, the sink waits for samples forever, so the bus is checked
+	// periodically.
+	GstSample *sample = nullptr;
+	while (sample == nullptr) {
+		sample = gst_app_sink_try_pull_sample(
+		    GST_APP_SINK(d_sink),
+		    SAMPLE_TIMEOUT_MS * GST_MSECOND
+		);
+		if (sample == nullptr && segmentEnded()) {
+			return nullptr;
+		}
+	}
+	Defer {
+		gst_sample_unref(sample);
+	};
+
+	gint width = 0, height = 0;
+	auto structure = gst_caps_get_structure(gst_sample_get_caps(sample), 0);
+	gst_structure_get_int(structure, "width", &width);
+	gst_structure_get_int(structure, "height", &height);
+
+	GstMapInfo map;
+	auto       sampleBuffer = gst_sample_get_buffer(sample);
+	if (gst_buffer_map(sampleBuffer, &map, GST_MAP_READ) == false) {
+		throw cpptrace::runtime_error("could not map decoded buffer");
+	}
+	Defer {
+		gst_buffer_unmap(sampleBuffer, &map);
+	};
+
+	// GRAY8 rows are padded to 4 bytes by gstreamer.
+	const size_t srcStride = GST_ROUND_UP_4(width);
+	if (map.size < srcStride * height) {
+		throw cpptrace::runtime_error(
+		    "decoded buffer is too small: " + std::to_string(map.size) +
+		    " < " + std::to_string(srcStride * height)
+		);
+	}
+	const size_t stride = (width + 63) & ~63;
+	auto         buffer =
+	    static_cast<uint8_t *>(aligned_alloc(64, stride * height));
+	auto res =
+	    ImageU8::OwnedPtr{new ImageU8{width, height, buffer, int32_t(stride)}};
+	for (int y = 0; y < height; ++y) {
+		memcpy(res->buffer + y * stride, map.data + y * srcStride, width);
+	}
+	return res;
+}
+
+Frame::Ptr VideoSegmentSource::pullFrame() {
+	while (true) {
+		auto image = pullImage();
+		if (image == nullptr) {
+			if (openNextSegment() == false) {
+				return nullptr;
+			}
+			continue;
+		}
+		auto global = d_frameMatching.find(d_streamID++);
+		if (global == d_frameMatching.end()) {
+			// the encoder may output frames after the last association.
+			d_logger.Debug(
+			    "skipping unmatched frame",
+			    slog::Int("stream_id", d_streamID - 1)
+			);
+			continue;
+		}
+		if (d_pending != nullptr && image->Size() != d_resolution) {
+			throw cpptrace::runtime_error(
+			    "segments of '" + d_segments.front().Video.string() +
+			    "' have different sizes"
+			);
+		}
+		return std::make_shared<DecodedFrame>(
+		    std::move(image),
+		    global->second,
+		    uint64_t(global->second * d_period.Microseconds())
+		);
+	}
+}
+
+Frame::Ptr VideoSegmentSource::Next() {
+	auto res  = d_pending;
+	d_pending = res == nullptr ? nullptr : pullFrame();
+	return res;
+}
+
+Size VideoSegmentSource::Resolution() const {
+	return d_resolution;
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "FrameGrabber.hpp"
+#include "ImageU8.hpp"
+
+#include "video/gstreamer.hpp"
+
+namespace fort {
+namespace artemis {
+
+// A frame decoded from an archive, owning its image.
+class DecodedFrame : public Frame {
+public:
+	DecodedFrame(ImageU8::OwnedPtr image, uint64_t ID, uint64_t timestamp);
+	virtual ~DecodedFrame();
+
+	void    *Data() override;
+	size_t   Width() const override;
+	size_t   Height() const override;
+	uint64_t Timestamp() const override;
+	uint64_t ID() const override;
+	ImageU8  ToImageU8() override;
+
+private:
+	ImageU8::OwnedPtr d_image;
+	uint64_t          d_ID, d_timestamp;
+};
+
+// Reads archived frames in order, as fast as they can be decoded. Archives
+// have no acquisition time, so timestamps are computed from the frame IDs and
+// the nominal FPS.
+class FrameSource {
+public:
+	typedef std::unique_ptr<FrameSource> Ptr;
+
+	// Opens either a directory of PNG files, read in lexicographic order, or
+	// a video output directory with its 'stream.%04d.mp4' segments and their
+	// 'stream.frame-matching.%04d.txt' files.
+	static Ptr Open(const std::filesystem::path &path, double FPS);
+
+	virtual ~FrameSource();
+
+	// Returns the next frame, or nullptr once the archive is exhausted.
+	virtual Frame::Ptr Next() = 0;
+
+	virtual Size Resolution() const = 0;
+};
+
+class PNGSequenceSource : public FrameSource {
+public:
+	PNGSequenceSource(std::vector<std::filesystem::path> paths, double FPS);
+	virtual ~PNGSequenceSource();
+
+	Frame::Ptr Next() override;
+	Size       Resolution() const override;
+
+private:
+	std::vector<std::filesystem::path> d_paths;
+	size_t                             d_next = 0;
+	Duration                           d_period;
+	Size                               d_resolution;
+};
+
+class VideoSegmentSource : public FrameSource {
+public:
+	struct Segment {
+		std::filesystem::path Video, FrameMatching;
+	};
+
+	// Reads the stream to global frame ID associations written by
+	// MetadataFile.
+	static std::map<uint64_t, uint64_t>
+	ReadFrameMatching(const std::filesystem::path &path);
+
+	// Lists the segments of a video output directory, in order.
+	static std::vector<Segment> ListSegments(const std::filesystem::path &dir);
+
+	VideoSegmentSource(std::vector<Segment> segments, double FPS);
+	virtual ~VideoSegmentSource();
+
+	Frame::Ptr Next() override;
+	Size       Resolution() const override;
+
+private:
+	constexpr static uint64_t SAMPLE_TIMEOUT_MS = 100;
+
+	bool              openNextSegment();
+	void              closeSegment();
+	// Returns true once the current segment is decoded or failed, and
+	// reports its decoding errors and missing frames.
+	bool              segmentEnded();
+	ImageU8::OwnedPtr pullImage();
+	Frame::Ptr        pullFrame();
+
+	std::vector<Segment>         d_segments;
+	size_t                       d_segment = 0;
+	std::map<uint64_t, uint64_t> d_frameMatching;
+	uint64_t                     d_streamID = 0;
+	Duration                     d_period;
+	Size                         d_resolution;
+
+	GstElementPtr d_pipeline;
+	GstElement   *d_sink = nullptr;
+	Frame::Ptr    d_pending;
+
+	slog::Logger<1> d_logger;
+};
+
+} // namespace artemis
+} // namespace fort
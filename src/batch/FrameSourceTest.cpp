@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <fstream>
+
+#include "FrameSource.hpp"
+
+namespace fort {
+namespace artemis {
+
+class FrameSourceTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		d_dir = std::filesystem::temp_directory_path() /
+		        ("artemis-frame-source-" + std::to_string(getpid()));
+		std::filesystem::create_directories(d_dir);
+	}
+
+	void TearDown() override {
+		std::filesystem::remove_all(d_dir);
+	}
+
+	void writeFile(const std::string &name, const std::string &content) {
+		std::ofstream out{d_dir / name};
+		out << content;
+	}
+
+	std::filesystem::path d_dir;
+};
+
+TEST_F(FrameSourceTest, ReadsFrameMatching) {
+	writeFile("stream.frame-matching.0000.txt", "0 30\n1 31\n\n2 33\n");
+	auto matching = VideoSegmentSource::ReadFrameMatching(
+	    d_dir / "stream.frame-matching.0000.txt"
+	);
+	EXPECT_EQ(
+	    matching,
+	    (std::map<uint64_t, uint64_t>{{0, 30}, {1, 31}, {2, 33}})
+	);
+
+	writeFile("stream.frame-matching.0001.txt", "0 30\n1\n");
+	EXPECT_THROW(
+	    VideoSegmentSource::ReadFrameMatching(
+	        d_dir / "stream.frame-matching.0001.txt"
+	    ),
+	    std::runtime_error
+	);
+	EXPECT_THROW(
+	    VideoSegmentSource::ReadFrameMatching(d_dir / "nope.txt"),
+	    std::runtime_error
+	);
+}
+
+TEST_F(FrameSourceTest, ListsSegmentsInOrder) {
+	for (const auto &index : {"0002", "0000", "0001"}) {
+		writeFile("stream." + std::string{index} + ".mp4", "");
+		writeFile(
+		    "stream.frame-matching." + std::string{index} + ".txt",
+		    "0 0\n"
+		);
+	}
+	writeFile("other.mp4", "");
+
+	auto segments = VideoSegmentSource::ListSegments(d_dir);
+	ASSERT_EQ(segments.size(), 3);
+	for (size_t i = 0; i < 3; ++i) {
+		EXPECT_EQ(
+		    segments[i].Video.filename(),
+		    "stream.000" + std::to_string(i) + ".mp4"
+		);
+		EXPECT_EQ(
+		    segments[i].FrameMatching.filename(),
+		    "stream.frame-matching.000" + std::to_string(i) + ".txt"
+		);
+	}
+
+	std::filesystem::remove(d_dir / "stream.frame-matching.0001.txt");
+	EXPECT_THROW(VideoSegmentSource::ListSegments(d_dir), std::runtime_error);
+}
+
+TEST_F(FrameSourceTest, ChecksInput) {
+	EXPECT_THROW(FrameSource::Open(d_dir, 8.0), std::invalid_argument);
+	EXPECT_THROW(FrameSource::Open(d_dir / "nope", 8.0), std::invalid_argument);
+	EXPECT_THROW(FrameSource::Open(d_dir, 0.0), std::invalid_argument);
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,128 @@
+#include "ReadoutWriter.hpp"
+
+#include <fcntl.h>
+
+#include <cstdio>
+#include <system_error>
+
+#include <google/protobuf/io/gzip_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/util/delimited_message_util.h>
+
+#include <fort/hermes/Header.pb.h>
+
+#include <cpptrace/cpptrace.hpp>
+
+#include <slog++/slog++.hpp>
+
+namespace fort {
+namespace artemis {
+
+ReadoutWriter::ReadoutWriter(
+    const std::filesystem::path &dir, size_t segmentSize
+)
+    : d_dir{dir}
+    , d_segmentSize{segmentSize} {
+	if (d_segmentSize == 0) {
+		throw std::invalid_argument("segment size must be positive");
+	}
+	std::filesystem::create_directories(d_dir);
+}
+
+ReadoutWriter::~ReadoutWriter() {
+	try {
+		Close();
+	} catch (const std::exception &e) {
+		slog::Error("could not close readout file", slog::Err(e));
+	}
+}
+
+void ReadoutWriter::Close() {
+	if (d_gzip != nullptr) {
+		closeSegment(true);
+	}
+}
+
+std::string ReadoutWriter::SegmentName(size_t index) {
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "tracking.%04zu.hermes", index);
+	return buffer;
+}
+
+size_t ReadoutWriter::Written() const {
+	return d_written;
+}
+
+void ReadoutWriter::openSegment() {
+	const auto path = d_dir / SegmentName(d_segment);
+	int fd = open(path.c_str(), O_CREAT | O_TRUNC | O_WRONLY | O_CLOEXEC, 0644);
+	if (fd < 0) {
+		throw std::system_error{
+		    errno,
+		    std::generic_category(),
+		    "open(\"" + path.string() + "\")"
+		};
+	}
+	d_file = std::make_unique<google::protobuf::io::FileOutputStream>(fd);
+	d_file->SetCloseOnDelete(true);
+	d_gzip = std::make_unique<google::protobuf::io::GzipOutputStream>(
+	    d_file.get()
+	);
+
+	hermes::Header header;
+	header.set_type(hermes::Header::File);
+	header.mutable_version()->set_vmajor(0);
+	header.mutable_version()->set_vminor(5);
+	if (d_segment > 0) {
+		header.set_previous(SegmentName(d_segment - 1));
+	}
+	google::protobuf::util::SerializeDelimitedToZeroCopyStream(
+	    header,
+	    d_gzip.get()
+	);
+	d_inSegment = 0;
+}
+
+void ReadoutWriter::closeSegment(bool last) {
+	hermes::FileLine line;
+	line.mutable_footer()->set_next(last ? "" : SegmentName(d_segment + 1));
+	google::protobuf::util::SerializeDelimitedToZeroCopyStream(
+	    line,
+	    d_gzip.get()
+	);
+	bool ok = d_gzip->Close();
+	d_gzip.reset();
+	ok = d_file->Close() && ok;
+	d_file.reset();
+	if (ok == false) {
+		throw cpptrace::runtime_error(
+		    "could not write '" + (d_dir / SegmentName(d_segment)).string() +
+		    "'"
+		);
+	}
+	++d_segment;
+}
+
+void ReadoutWriter::Write(const hermes::FrameReadout &readout) {
+	if (d_gzip != nullptr && d_inSegment >= d_segmentSize) {
+		closeSegment(false);
+	}
+	if (d_gzip == nullptr) {
+		openSegment();
+	}
+	hermes::FileLine line;
+	*line.mutable_readout() = readout;
+	if (google::protobuf::util::SerializeDelimitedToZeroCopyStream(
+	        line,
+	        d_gzip.get()
+	    ) == false) {
+		throw cpptrace::runtime_error(
+		    "could not write readout " + std::to_string(readout.frameid())
+		);
+	}
+	++d_inSegment;
+	++d_written;
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+
+#include <fort/hermes/FrameReadout.pb.h>
+
+namespace google {
+namespace protobuf {
+namespace io {
+class FileOutputStream;
+class GzipOutputStream;
+} // namespace io
+} // namespace protobuf
+} // namespace google
+
+namespace fort {
+namespace artemis {
+
+// Writes readouts to 'tracking.%04d.hermes' segment files, in the format of
+// the files written by leto: each segment is a gzipped sequence of delimited
+// messages, a Header followed by FileLines, the last one having a footer
+// naming the next segment.
+class ReadoutWriter {
+public:
+	constexpr static size_t DEFAULT_SEGMENT_SIZE = 10000;
+
+	ReadoutWriter(
+	    const std::filesystem::path &dir,
+	    size_t                       segmentSize = DEFAULT_SEGMENT_SIZE
+	);
+
+	// Closes the last segment if Close() was not called, errors are then only
+	// logged.
+	~ReadoutWriter();
+
+	ReadoutWriter(const ReadoutWriter &)            = delete;
+	ReadoutWriter(ReadoutWriter &&)                 = delete;
+	ReadoutWriter &operator=(const ReadoutWriter &) = delete;
+	ReadoutWriter &operator=(ReadoutWriter &&)      = delete;
+
+	static std::string SegmentName(size_t index);
+
+	// Not thread-safe: readouts are written in the order of the calls.
+	void Write(const hermes::FrameReadout &readout);
+
+	// Closes the last segment.
+	void Close();
+
+	size_t Written() const;
+
+private:
+	void openSegment();
+	void closeSegment(bool last);
+
+	std::filesystem::path d_dir;
+	size_t                d_segmentSize;
+	size_t                d_segment = 0, d_inSegment = 0, d_written = 0;
+
+	std::unique_ptr<google::protobuf::io::FileOutputStream> d_file;
+	std::unique_ptr<google::protobuf::io::GzipOutputStream> d_gzip;
+};
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <google/protobuf/io/gzip_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/util/delimited_message_util.h>
+
+#include <fort/hermes/Header.pb.h>
+
+#include "ReadoutWriter.hpp"
+
+namespace fort {
+namespace artemis {
+
+class ReadoutWriterTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		d_dir = std::filesystem::temp_directory_path() /
+		        ("artemis-readout-writer-" + std::to_string(getpid()));
+	}
+
+	void TearDown() override {
+		std::filesystem::remove_all(d_dir);
+	}
+
+	struct Segment {
+		hermes::Header        Header;
+		std::vector<uint64_t> FrameIDs;
+		std::string           Next;
+		bool                  HasFooter = false;
+	};
+
+	Segment readSegment(size_t index) {
+		const auto path = d_dir / ReadoutWriter::SegmentName(index);
+		int        fd   = open(path.c_str(), O_RDONLY);
+		EXPECT_GE(fd, 0) << path;
+		google::protobuf::io::FileInputStream file{fd};
+		file.SetCloseOnDelete(true);
+		google::protobuf::io::GzipInputStream gzip{&file};
+
+		Segment res;
+		bool    clean;
+		EXPECT_TRUE(google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+		    &res.Header,
+		    &gzip,
+		    &clean
+		));
+		hermes::FileLine line;
+		while (google::protobuf::util::ParseDelimitedFromZeroCopyStream(
+		    &line,
+		    &gzip,
+		    &clean
+		)) {
+			if (line.has_footer()) {
+				res.HasFooter = true;
+				res.Next      = line.footer().next();
+			} else {
+				res.FrameIDs.push_back(line.readout().frameid());
+			}
+		}
+		return res;
+	}
+
+	std::filesystem::path d_dir;
+};
+
+TEST_F(ReadoutWriterTest, WritesSegments) {
+	{
+		ReadoutWriter writer{d_dir, 2};
+		for (uint64_t ID = 10; ID < 15; ++ID) {
+			hermes::FrameReadout readout;
+			readout.set_frameid(ID);
+			writer.Write(readout);
+		}
+		writer.Close();
+		EXPECT_EQ(writer.Written(), 5);
+	}
+
+	auto first = readSegment(0);
+	EXPECT_EQ(first.Header.type(), hermes::Header::File);
+	EXPECT_EQ(first.Header.previous(), "");
+	EXPECT_EQ(first.FrameIDs, (std::vector<uint64_t>{10, 11}));
+	EXPECT_TRUE(first.HasFooter);
+	EXPECT_EQ(first.Next, "tracking.0001.hermes");
+
+	auto second = readSegment(1);
+	EXPECT_EQ(second.Header.previous(), "tracking.0000.hermes");
+	EXPECT_EQ(second.FrameIDs, (std::vector<uint64_t>{12, 13}));
+	EXPECT_EQ(second.Next, "tracking.0002.hermes");
+
+	auto last = readSegment(2);
+	EXPECT_EQ(last.FrameIDs, (std::vector<uint64_t>{14}));
+	EXPECT_TRUE(last.HasFooter);
+	EXPECT_EQ(last.Next, "");
+
+	EXPECT_FALSE(
+	    std::filesystem::exists(d_dir / ReadoutWriter::SegmentName(3))
+	);
+}
+
+TEST_F(ReadoutWriterTest, ChecksSegmentSize) {
+	EXPECT_THROW(ReadoutWriter(d_dir, 0), std::invalid_argument);
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <cstdlib>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+#include "ImageU8.hpp"
+
+namespace fort {
+namespace artemis {
+
+// resolutions of the cameras used on the tracking rigs.
+constexpr std::array<std::pair<int64_t, int64_t>, 3> RIG_RESOLUTIONS = {{
+    {2048, 1536},
+    {4096, 3000},
+    {6464, 4852},
+}};
+
+// Adds the rig resolutions as the width and height arguments of b.
+inline void RigResolutions(benchmark::internal::Benchmark *b) {
+	b->ArgNames({"width", "height"});
+	for (const auto &[width, height] : RIG_RESOLUTIONS) {
+		b->Args({width, height});
+	}
+}
+
+// Returns an image with a 64 bytes aligned stride, filled with a gradient so
+// pages are actually mapped.
+inline ImageU8::OwnedPtr AllocateImage(int32_t width, int32_t height) {
+	const int32_t stride = (width + 63) & ~63;
+	auto          buffer =
+	    static_cast<uint8_t *>(aligned_alloc(64, size_t(stride) * height));
+	for (int32_t y = 0; y < height; ++y) {
+		for (int32_t x = 0; x < stride; ++x) {
+			buffer[y * stride + x] = uint8_t(x + y);
+		}
+	}
+	return ImageU8::OwnedPtr{new ImageU8{width, height, buffer, stride}};
+}
+
+} // namespace artemis
+} // namespace fort
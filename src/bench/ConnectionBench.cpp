@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+
+#include <fort/hermes/FrameReadout.pb.h>
+
+#include "Connection.hpp"
+
+namespace fort {
+namespace artemis {
+
+// Serialization of a readout before it is queued to the leto connection.
+static void BM_ConnectionSerialize(benchmark::State &state) {
+	hermes::FrameReadout readout;
+	readout.set_frameid(123456);
+	readout.set_timestamp(1234567890);
+	readout.set_producer_uuid("b4a1c6f2-3e5d-4c8a-9f0e-2d7b1a6c5e43");
+	readout.set_width(6464);
+	readout.set_height(4852);
+	readout.set_quads(3 * state.range(0));
+	for (int64_t i = 0; i < state.range(0); ++i) {
+		auto t = readout.add_tags();
+		t->set_id(i);
+		t->set_x(12.5 * i);
+		t->set_y(4852 - 3.25 * i);
+		t->set_theta(0.01 * i);
+	}
+
+	size_t bytes{0};
+	for (auto _ : state) {
+		auto serialized = Connection::Serialize(readout);
+		bytes += serialized.size();
+		benchmark::DoNotOptimize(serialized.data());
+	}
+	state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_ConnectionSerialize)
+    ->ArgName("tags")
+    ->Arg(0)
+    ->Arg(100)
+    ->Arg(1000);
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,228 @@
+#include "DetectionBenchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <slog++/slog++.hpp>
+
+#include <fort/hermes/FrameReadout.pb.h>
+#include <fort/time/Time.hpp>
+
+#include "SyntheticFrameGrabber.hpp"
+#include "batch/FrameSource.hpp"
+
+namespace fort {
+namespace artemis {
+
+namespace details {
+// Returns the resident memory of the process, in bytes.
+size_t ResidentBytes() {
+	std::ifstream statm{"/proc/self/statm"};
+	size_t        total{0}, resident{0};
+	statm >> total >> resident;
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+size_t PeakResidentBytes() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return size_t(usage.ru_maxrss) * 1024;
+}
+
+double ToMB(size_t bytes) {
+	return bytes / 1024.0 / 1024.0;
+}
+} // namespace details
+
+void DetectionBenchmark::Result::Add(
+    double wall, const ApriltagDetector::Profile &profile, size_t tags
+) {
+	Frames += 1;
+	Elapsed += wall;
+	Partitions = profile.Partitions;
+	Quads += profile.Quads;
+	Tags += tags;
+
+	Wall.push_back(wall);
+	Copy.push_back(profile.Copy);
+	Merge.push_back(profile.Merge);
+	double detect{0.0};
+	for (const auto &[name, elapsed] : profile.Detect) {
+		detect += elapsed;
+		auto it = std::find_if(
+		    Stages.begin(),
+		    Stages.end(),
+		    [&name](const auto &s) { return s.first == name; }
+		);
+		if (it == Stages.end()) {
+			Stages.push_back({name, {}});
+			it = Stages.end() - 1;
+		}
+		it->second.push_back(elapsed);
+	}
+	Detect.push_back(detect);
+}
+
+double DetectionBenchmark::Percentile(std::vector<double> values, double p) {
+	if (values.empty()) {
+		return 0.0;
+	}
+	const size_t rank = std::clamp(
+	    size_t(std::ceil(p / 100.0 * values.size())),
+	    size_t(1),
+	    values.size()
+	);
+	std::nth_element(values.begin(), values.begin() + rank - 1, values.end());
+	return values[rank - 1];
+}
+
+void DetectionBenchmark::Execute(int argc, char **argv) {
+	BenchDetectOptions options;
+	options.SetDescription(
+	    "measures tag detection on preloaded frames, and reports its latency "
+	    "per phase"
+	);
+	options.ParseArguments(argc, (const char **)argv);
+	options.Validate();
+
+	DetectionBenchmark benchmark{options};
+	const size_t       first = options.Sweep ? 1 : options.Threads;
+	for (size_t concurrency = first; concurrency <= options.Threads;
+	     ++concurrency) {
+		benchmark.Report(benchmark.Run(concurrency));
+	}
+}
+
+DetectionBenchmark::DetectionBenchmark(const BenchDetectOptions &options)
+    : d_warmup{options.Warmup}
+    , d_measured{options.Frames}
+    , d_executor{options.Threads}
+    , d_logger{slog::With(slog::String("task", "DetectionBenchmark"))} {
+	load(options);
+
+	const Size size{int(d_frames[0]->Width()), int(d_frames[0]->Height())};
+	const auto before = details::ResidentBytes();
+	d_detector        = std::make_unique<ApriltagDetector>(
+        options.Threads,
+        size,
+        options.Apriltag
+    );
+	const auto after = details::ResidentBytes();
+	d_detectorBytes  = after > before ? after - before : 0;
+
+	d_logger.Info(
+	    "benchmarking",
+	    slog::Int("width", size.width()),
+	    slog::Int("height", size.height()),
+	    slog::Int("preloaded", d_frames.size()),
+	    slog::Int("threads", options.Threads),
+	    slog::Int("tilesPerWorker", options.Apriltag.TilesPerWorker)
+	);
+}
+
+DetectionBenchmark::~DetectionBenchmark() {}
+
+void DetectionBenchmark::load(const BenchDetectOptions &options) {
+	// frames are decoded or rendered up front, so only detection is measured.
+	if (options.Input.empty()) {
+		SyntheticFrameGrabber grabber{options.Synthetic, 0.0};
+		grabber.Start();
+		while (d_frames.size() < options.Preload) {
+			d_frames.push_back(grabber.NextFrame());
+		}
+		return;
+	}
+
+	// timestamps do not matter here, any FPS will do.
+	auto source = FrameSource::Open(options.Input, 1.0);
+	while (d_frames.size() < options.Preload) {
+		auto frame = source->Next();
+		if (frame == nullptr) {
+			break;
+		}
+		d_frames.push_back(std::move(frame));
+	}
+	if (d_frames.empty()) {
+		throw std::runtime_error("no frame in '" + options.Input + "'");
+	}
+}
+
+DetectionBenchmark::Result DetectionBenchmark::Run(size_t concurrency) {
+	d_detector->SetMaxConcurrency(concurrency);
+
+	Result res;
+	res.Concurrency = d_detector->MaxConcurrency();
+
+	ApriltagDetector::Profile profile;
+	hermes::FrameReadout      readout;
+	d_detector->SetProfile(&profile);
+	for (size_t i = 0; i < d_warmup + d_measured; ++i) {
+		const auto &frame = d_frames[i % d_frames.size()];
+		readout.Clear();
+		readout.set_frameid(i);
+		readout.set_timestamp(frame->Timestamp());
+
+		const auto start = Time::Now();
+		d_detector->SetInputOutput(frame->ToImageU8(), &readout);
+		d_executor.run(d_detector->Taskflow()).wait();
+		const double wall = Time::Now().Sub(start).Seconds();
+		if (i >= d_warmup) {
+			res.Add(wall, profile, readout.tags_size());
+		}
+	}
+	d_detector->SetProfile(nullptr);
+	return res;
+}
+
+void DetectionBenchmark::Report(const Result &result) {
+	const auto report = [this, &result](
+	                        const std::string         &phase,
+	                        const std::vector<double> &latencies
+	                    ) {
+		d_logger.Info(
+		    "latency",
+		    slog::Int("concurrency", result.Concurrency),
+		    slog::String("phase", phase),
+		    slog::Float("p50_ms", Percentile(latencies, 50.0) * 1.0e3),
+		    slog::Float("p99_ms", Percentile(latencies, 99.0) * 1.0e3)
+		);
+	};
+
+	// copy and detect phases are summed over partitions, so they are CPU
+	// time rather than wall time when partitions run concurrently.
+	report("wall", result.Wall);
+	report("copy", result.Copy);
+	report("detect", result.Detect);
+	for (const auto &[name, latencies] : result.Stages) {
+		report("detect/" + name, latencies);
+	}
+	report("merge", result.Merge);
+
+	const double elapsed = std::max(result.Elapsed, 1.0e-9);
+	d_logger.Info(
+	    "throughput",
+	    slog::Int("concurrency", result.Concurrency),
+	    slog::Int("frames", result.Frames),
+	    slog::Int("partitions", result.Partitions),
+	    slog::Float("fps", result.Frames / elapsed),
+	    slog::Float("quads_per_s", result.Quads / elapsed),
+	    slog::Float("tags_per_frame", double(result.Tags) / result.Frames)
+	);
+
+	d_logger.Info(
+	    "memory",
+	    slog::Float("detector_MB", details::ToMB(d_detectorBytes)),
+	    slog::Float("resident_MB", details::ToMB(details::ResidentBytes())),
+	    slog::Float(
+	        "peak_resident_MB",
+	        details::ToMB(details::PeakResidentBytes())
+	    )
+	);
+}
+
+} // namespace artemis
+} // namespace fort
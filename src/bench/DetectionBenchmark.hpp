@@ -0,0 +1,65 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <taskflow/taskflow.hpp>
+
+#include <slog++/Logger.hpp>
+
+#include "FrameGrabber.hpp"
+#include "Options.hpp"
+
+#include "ApriltagDetector.hpp"
+
+namespace fort {
+namespace artemis {
+
+// Measures ApriltagDetector alone, on frames preloaded in memory, and breaks
+// its latency down into the copy, apriltag stages and merge phases.
+class DetectionBenchmark {
+public:
+	struct Result {
+		size_t Concurrency = 0, Frames = 0, Partitions = 0;
+		size_t Quads = 0, Tags = 0;
+		// total wall time of the measured detections, in seconds.
+		double Elapsed = 0.0;
+
+		// per frame latencies, in seconds.
+		std::vector<double>                                      Wall;
+		std::vector<double>                                      Copy;
+		std::vector<double>                                      Detect;
+		std::vector<double>                                      Merge;
+		std::vector<std::pair<std::string, std::vector<double>>> Stages;
+
+		void Add(
+		    double wall, const ApriltagDetector::Profile &profile, size_t tags
+		);
+	};
+
+	// Returns the p-th percentile of values, using the nearest rank.
+	static double Percentile(std::vector<double> values, double p);
+
+	static void Execute(int argc, char **argv);
+
+	DetectionBenchmark(const BenchDetectOptions &options);
+	~DetectionBenchmark();
+
+	Result Run(size_t concurrency);
+
+	void Report(const Result &result);
+
+private:
+	void load(const BenchDetectOptions &options);
+
+	std::vector<Frame::Ptr>           d_frames;
+	size_t                            d_warmup, d_measured;
+	size_t                            d_detectorBytes = 0;
+	tf::Executor                      d_executor;
+	std::unique_ptr<ApriltagDetector> d_detector;
+	slog::Logger<1>                   d_logger;
+};
+
+} // namespace artemis
+} // namespace fort
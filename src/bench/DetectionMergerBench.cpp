@@ -0,0 +1,51 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "utils/DetectionMerger.hpp"
+
+namespace fort {
+namespace artemis {
+
+// Tags spread over vertical strips, with the ones in the overlap between two
+// strips detected by both, as partitions with margins produce.
+static void BM_DetectionMergerMerge(benchmark::State &state) {
+	const size_t tags = state.range(0), partitions = state.range(1);
+	const double width = 6464, height = 4852, overlap = 150;
+	const double stripWidth = width / partitions;
+
+	std::mt19937                           rng{42};
+	std::uniform_real_distribution<double> x{0.0, width}, y{0.0, height};
+	std::normal_distribution<double>       jitter{0.0, 0.3};
+
+	std::vector<DetectionMerger::List> lists(partitions);
+	for (size_t i = 0; i < tags; ++i) {
+		DetectionMerger::Detection d{
+		    .ID    = uint32_t(i),
+		    .X     = x(rng),
+		    .Y     = y(rng),
+		    .Theta = 0.0,
+		};
+		const size_t strip = std::min(size_t(d.X / stripWidth), partitions - 1);
+		lists[strip].push_back(d);
+		if (strip + 1 < partitions && d.X > (strip + 1) * stripWidth - overlap) {
+			d.X += jitter(rng);
+			d.Y += jitter(rng);
+			lists[strip + 1].push_back(d);
+		}
+	}
+
+	DetectionMerger merger{10.0};
+	for (auto _ : state) {
+		const auto &merged = merger.Merge(lists);
+		benchmark::DoNotOptimize(merged.data());
+	}
+	state.SetItemsProcessed(state.iterations() * tags);
+}
+
+BENCHMARK(BM_DetectionMergerMerge)
+    ->ArgNames({"tags", "partitions"})
+    ->ArgsProduct({{100, 1000, 4000}, {4, 16, 64}});
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,35 @@
+#include <benchmark/benchmark.h>
+
+#include "BenchmarkImages.hpp"
+#include "utils/ImageKernels.hpp"
+
+namespace fort {
+namespace artemis {
+
+typedef void (*CopyAndBlurFunction)(
+    ImageU8 &, const ImageU8 &, const GaussianKernel &
+);
+
+// A quarter of the frame, as when copying a partition, blurred with the
+// kernel of quad_sigma 0.8.
+template <CopyAndBlurFunction Function>
+static void BM_CopyAndBlur(benchmark::State &state) {
+	auto       src = AllocateImage(state.range(0), state.range(1));
+	const Rect roi{
+	    {int(state.range(0) / 4), int(state.range(1) / 4)},
+	    {int(state.range(0) / 2), int(state.range(1) / 2)},
+	};
+	auto       dst    = AllocateImage(roi.width(), roi.height());
+	const auto kernel = GaussianKernel::ForQuadSigma(0.8);
+	for (auto _ : state) {
+		Function(*dst, src->GetROI(roi), kernel);
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * dst->NeededSize());
+}
+
+BENCHMARK(BM_CopyAndBlur<CopyAndBlur>)->Apply(RigResolutions);
+BENCHMARK(BM_CopyAndBlur<CopyAndBlurScalar>)->Apply(RigResolutions);
+
+} // namespace artemis
+} // namespace fort
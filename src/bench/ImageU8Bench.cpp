@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include <taskflow/taskflow.hpp>
+
+#include "BenchmarkImages.hpp"
+
+namespace fort {
+namespace artemis {
+
+// Same stride, copied by a single memcpy.
+static void BM_ImageU8CopyFrame(benchmark::State &state) {
+	auto src = AllocateImage(state.range(0), state.range(1));
+	auto dst = AllocateImage(state.range(0), state.range(1));
+	for (auto _ : state) {
+		ImageU8::Copy(*dst, *src);
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * src->NeededSize());
+}
+
+BENCHMARK(BM_ImageU8CopyFrame)->Apply(RigResolutions);
+
+// A quarter of the frame, as when copying a partition, copied line by line.
+static void BM_ImageU8CopyROI(benchmark::State &state) {
+	auto       src = AllocateImage(state.range(0), state.range(1));
+	const Rect roi{
+	    {int(state.range(0) / 4), int(state.range(1) / 4)},
+	    {int(state.range(0) / 2), int(state.range(1) / 2)},
+	};
+	auto dst = AllocateImage(roi.width(), roi.height());
+	for (auto _ : state) {
+		ImageU8::Copy(*dst, src->GetROI(roi));
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * dst->NeededSize());
+}
+
+BENCHMARK(BM_ImageU8CopyROI)->Apply(RigResolutions);
+
+// Same copy, with one task per line. Includes the cost of running the
+// taskflow.
+static void BM_ImageU8CopyROIRuntime(benchmark::State &state) {
+	auto       src = AllocateImage(state.range(0), state.range(1));
+	const Rect roi{
+	    {int(state.range(0) / 4), int(state.range(1) / 4)},
+	    {int(state.range(0) / 2), int(state.range(1) / 2)},
+	};
+	auto         dst = AllocateImage(roi.width(), roi.height());
+	ImageU8      srcROI{src->GetROI(roi)};
+	tf::Executor executor;
+	tf::Taskflow taskflow;
+	taskflow.emplace([&](tf::Runtime &rt) { ImageU8::Copy(*dst, srcROI, &rt); }
+	);
+	for (auto _ : state) {
+		executor.run(taskflow).wait();
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * dst->NeededSize());
+	state.counters["workers"] = executor.num_workers();
+}
+
+BENCHMARK(BM_ImageU8CopyROIRuntime)->Apply(RigResolutions)->UseRealTime();
+
+// Downscale to the 1080 lines working resolution of the process task.
+static void BM_ImageU8Resize(benchmark::State &state) {
+	const int32_t width = state.range(0), height = state.range(1);
+	const auto    mode  = ImageU8::ScaleMode(state.range(2));
+	auto          src   = AllocateImage(width, height);
+	auto          dst   = AllocateImage(width * 1080 / height, 1080);
+	for (auto _ : state) {
+		ImageU8::Resize(*dst, *src, mode);
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * src->NeededSize());
+}
+
+static void ResizeArguments(benchmark::internal::Benchmark *b) {
+	b->ArgNames({"width", "height", "mode"});
+	for (const auto &[width, height] : RIG_RESOLUTIONS) {
+		for (auto mode :
+		     {ImageU8::ScaleMode::None,
+		      ImageU8::ScaleMode::Linear,
+		      ImageU8::ScaleMode::Bilinear,
+		      ImageU8::ScaleMode::Box}) {
+			b->Args({width, height, int64_t(mode)});
+		}
+	}
+}
+
+BENCHMARK(BM_ImageU8Resize)->Apply(ResizeArguments);
+
+} // namespace artemis
+} // namespace fort
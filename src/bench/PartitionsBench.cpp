@@ -0,0 +1,69 @@
+#include <benchmark/benchmark.h>
+
+#include "ApriltagDetector.hpp"
+#include "utils/Partitions.hpp"
+
+#include "BenchmarkImages.hpp"
+
+namespace fort {
+namespace artemis {
+
+static void PartitionArguments(benchmark::internal::Benchmark *b) {
+	b->ArgNames({"width", "height", "tiles"});
+	for (const auto &[width, height] : RIG_RESOLUTIONS) {
+		for (int64_t tiles : {4, 16, 64}) {
+			b->Args({width, height, tiles});
+		}
+	}
+}
+
+// Equal area partitions of the full frame, as planned for every frame.
+static void BM_PartitionRectangle(benchmark::State &state) {
+	const Size size{int(state.range(0)), int(state.range(1))};
+	Partition  partition;
+	for (auto _ : state) {
+		partition.clear();
+		PartitionRectangle(Rect{{0, 0}, size}, state.range(2), partition);
+		AddMargin(size, ApriltagDetector::PARTITION_MARGIN, partition);
+		benchmark::DoNotOptimize(partition.data());
+	}
+}
+
+BENCHMARK(BM_PartitionRectangle)->Apply(PartitionArguments);
+
+// Adaptive partitions, balanced on a measured cost map.
+static void BM_PartitionRectangleCost(benchmark::State &state) {
+	const Size size{int(state.range(0)), int(state.range(1))};
+	const Rect frame{{0, 0}, size};
+	CostMap    costs(
+        size,
+        ApriltagDetector::COST_CELL_SIZE,
+        ApriltagDetector::COST_SMOOTHING
+    );
+	// denser in the top left corner, so partitions are not trivial.
+	Partition cells;
+	PartitionRectangle(frame, 64, cells);
+	for (const auto &cell : cells) {
+		costs.Record(cell, 1.0 / (1 + cell.x() + cell.y()));
+	}
+	costs.Update();
+
+	Partition partition;
+	for (auto _ : state) {
+		partition.clear();
+		PartitionRectangle(
+		    frame,
+		    state.range(2),
+		    costs,
+		    2 * ApriltagDetector::PARTITION_MARGIN,
+		    partition
+		);
+		AddMargin(size, ApriltagDetector::PARTITION_MARGIN, partition);
+		benchmark::DoNotOptimize(partition.data());
+	}
+}
+
+BENCHMARK(BM_PartitionRectangleCost)->Apply(PartitionArguments);
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,20 @@
+#include "DetectionBenchmark.hpp"
+#include "utils/SignalTraceHandler.hpp"
+
+#include <slog++/slog++.hpp>
+
+int main(int argc, char **argv) {
+
+	fort::artemis::InstallSignalSafeHandlers(argc, argv);
+
+	try {
+		fort::artemis::DetectionBenchmark::Execute(argc, argv);
+	} catch (const std::exception &e) {
+		slog::Error("Unhandled exception: ", slog::Err(e));
+		return 1;
+	} catch (...) {
+		slog::Error("Unhandled unknown error");
+		return 2;
+	}
+	return 0;
+}
@@ -0,0 +1,240 @@
+#include "DetectionMask.hpp"
+
+#include "StringManipulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <stdexcept>
+
+namespace fort {
+namespace artemis {
+
+DetectionMask::Ptr
+DetectionMask::Load(const std::string &spec, const Size &size) {
+	if (base::HasSuffix(spec, ".png") == false) {
+		return std::make_unique<DetectionMask>(size, ParsePolygons(spec));
+	}
+	auto image = ImageU8::ReadPNG(spec);
+	if (image->width != size.width() || image->height != size.height()) {
+		throw std::invalid_argument(
+		    "mask '" + spec + "' size (" + std::to_string(image->width) + "x" +
+		    std::to_string(image->height) + ") does not match frame size (" +
+		    std::to_string(size.width()) + "x" +
+		    std::to_string(size.height()) + ")"
+		);
+	}
+	return std::make_unique<DetectionMask>(*image);
+}
+
+std::vector<DetectionMask::Polygon>
+DetectionMask::ParsePolygons(const std::string &spec) {
+	std::vector<std::string> polygons;
+	base::SplitString(
+	    spec.cbegin(),
+	    spec.cend(),
+	    ";",
+	    std::back_inserter(polygons)
+	);
+
+	std::vector<Polygon> res;
+	for (auto &p : polygons) {
+		if (base::TrimSpaces(p).empty()) {
+			continue;
+		}
+		Polygon            polygon;
+		std::istringstream is(p);
+		std::string        vertex;
+		while (is >> vertex) {
+			double x, y;
+			char   comma, end;
+			const int n =
+			    std::sscanf(vertex.c_str(), "%lf%c%lf%c", &x, &comma, &y, &end);
+			if (n != 3 || comma != ',') {
+				throw std::invalid_argument(
+				    "cannot parse vertex '" + vertex + "' in mask '" + spec +
+				    "'"
+				);
+			}
+			polygon.push_back({x, y});
+		}
+		if (polygon.size() < 3) {
+			throw std::invalid_argument(
+			    "mask polygon '" + p + "' has less than 3 vertices"
+			);
+		}
+		res.push_back(std::move(polygon));
+	}
+	if (res.empty()) {
+		throw std::invalid_argument("mask '" + spec + "' has no polygon");
+	}
+	return res;
+}
+
+DetectionMask::DetectionMask(const ImageU8 &mask)
+    : d_size{mask.width, mask.height}
+    , d_mask(size_t(mask.width) * mask.height) {
+	for (int y = 0; y < mask.height; ++y) {
+		const uint8_t *in  = mask.buffer + y * mask.stride;
+		uint8_t       *out = d_mask.data() + y * mask.width;
+		for (int x = 0; x < mask.width; ++x) {
+			out[x] = in[x] != 0 ? 0xff : 0;
+		}
+	}
+	countBlocks();
+}
+
+DetectionMask::DetectionMask(
+    const Size &size, const std::vector<Polygon> &polygons
+)
+    : d_size{size}
+    , d_mask(size_t(size.width()) * size.height(), 0) {
+	std::vector<double> crossings;
+	for (const auto &polygon : polygons) {
+		// even-odd scanline fill, sampled at pixel centers.
+		for (int y = 0; y < size.height(); ++y) {
+			const double cy = y + 0.5;
+			crossings.clear();
+			for (size_t i = 0; i < polygon.size(); ++i) {
+				const auto &a = polygon[i];
+				const auto &b = polygon[(i + 1) % polygon.size()];
+				if ((a.y() <= cy) == (b.y() <= cy)) {
+					continue;
+				}
+				crossings.push_back(
+				    a.x() + (cy - a.y()) * (b.x() - a.x()) / (b.y() - a.y())
+				);
+			}
+			std::sort(crossings.begin(), crossings.end());
+			uint8_t *row = d_mask.data() + y * size.width();
+			for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+				// pixels whose center lies between the two crossings.
+				int start = std::max(int(std::ceil(crossings[i] - 0.5)), 0);
+				int end   = std::min(
+				    int(std::ceil(crossings[i + 1] - 0.5)),
+				    size.width()
+				);
+				if (start < end) {
+					std::fill(row + start, row + end, 0xff);
+				}
+			}
+		}
+	}
+	countBlocks();
+}
+
+void DetectionMask::countBlocks() {
+	d_blocksX = (d_size.width() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	d_blocksY = (d_size.height() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	d_blockCounts.assign(size_t(d_blocksX) * d_blocksY, 0);
+	for (int y = 0; y < d_size.height(); ++y) {
+		const uint8_t *row = d_mask.data() + y * d_size.width();
+		uint16_t      *counts =
+		    d_blockCounts.data() + (y / BLOCK_SIZE) * d_blocksX;
+		for (int x = 0; x < d_size.width(); ++x) {
+			counts[x / BLOCK_SIZE] += row[x] & 1;
+		}
+	}
+}
+
+const Size &DetectionMask::FrameSize() const {
+	return d_size;
+}
+
+bool DetectionMask::IsActive(double x, double y) const {
+	if (x < 0.0 || y < 0.0 || x >= d_size.width() || y >= d_size.height()) {
+		return false;
+	}
+	return d_mask[size_t(y) * d_size.width() + size_t(x)] != 0;
+}
+
+double DetectionMask::ActiveArea(const Rect &rect) const {
+	const int right  = std::min(rect.x() + rect.width(), d_size.width());
+	const int bottom = std::min(rect.y() + rect.height(), d_size.height());
+	double    res    = 0.0;
+	for (int by = std::max(rect.y(), 0) / BLOCK_SIZE;
+	     by < d_blocksY && by * BLOCK_SIZE < bottom;
+	     ++by) {
+		const int top = std::max(rect.y(), by * BLOCK_SIZE);
+		const int bh =
+		    std::min(d_size.height() - by * BLOCK_SIZE, BLOCK_SIZE);
+		const int h = std::min(bottom, by * BLOCK_SIZE + bh) - top;
+		for (int bx = std::max(rect.x(), 0) / BLOCK_SIZE;
+		     bx < d_blocksX && bx * BLOCK_SIZE < right;
+		     ++bx) {
+			const int left = std::max(rect.x(), bx * BLOCK_SIZE);
+			const int bw =
+			    std::min(d_size.width() - bx * BLOCK_SIZE, BLOCK_SIZE);
+			const int w = std::min(right, bx * BLOCK_SIZE + bw) - left;
+			// partially covered blocks are assumed uniform.
+			res += d_blockCounts[by * d_blocksX + bx] * double(w * h) /
+			       double(bw * bh);
+		}
+	}
+	return res;
+}
+
+Rect DetectionMask::ActiveBounds(const Rect &rect) const {
+	const int right  = std::min(rect.x() + rect.width(), d_size.width());
+	const int bottom = std::min(rect.y() + rect.height(), d_size.height());
+	int       minX = d_blocksX, minY = d_blocksY, maxX = -1, maxY = -1;
+	for (int by = std::max(rect.y(), 0) / BLOCK_SIZE;
+	     by < d_blocksY && by * BLOCK_SIZE < bottom;
+	     ++by) {
+		for (int bx = std::max(rect.x(), 0) / BLOCK_SIZE;
+		     bx < d_blocksX && bx * BLOCK_SIZE < right;
+		     ++bx) {
+			if (d_blockCounts[by * d_blocksX + bx] == 0) {
+				continue;
+			}
+			minX = std::min(minX, bx);
+			maxX = std::max(maxX, bx);
+			minY = std::min(minY, by);
+			maxY = std::max(maxY, by);
+		}
+	}
+	if (maxX < 0) {
+		return {rect.TopLeft(), Size{0, 0}};
+	}
+	return Clamp(
+	    Rect{
+	        {minX * BLOCK_SIZE, minY * BLOCK_SIZE},
+	        {(maxX - minX + 1) * BLOCK_SIZE, (maxY - minY + 1) * BLOCK_SIZE},
+	    },
+	    rect
+	);
+}
+
+void DetectionMask::Apply(ImageU8 &image, const Rect &roi) const {
+	if (ActiveArea(roi) >= double(roi.width()) * double(roi.height())) {
+		return;
+	}
+	for (int y = 0; y < image.height; ++y) {
+		const uint8_t *mask =
+		    d_mask.data() + size_t(roi.y() + y) * d_size.width() + roi.x();
+		uint8_t *row = image.buffer + y * image.stride;
+		for (int x = 0; x < image.width; ++x) {
+			row[x] &= mask[x];
+		}
+	}
+}
+
+CostMap DetectionMask::ActiveAreaMap(int cellSize) const {
+	CostMap res{d_size, cellSize, 1.0};
+	for (int y = 0; y < d_size.height(); y += cellSize) {
+		for (int x = 0; x < d_size.width(); x += cellSize) {
+			Rect cell{
+			    {x, y},
+			    {std::min(cellSize, d_size.width() - x),
+			     std::min(cellSize, d_size.height() - y)},
+			};
+			res.Record(cell, ActiveArea(cell));
+		}
+	}
+	res.Update();
+	return res;
+}
+
+} // namespace artemis
+} // namespace fort
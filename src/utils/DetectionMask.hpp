@@ -0,0 +1,66 @@
+#pragma once
+
+#include "ImageU8.hpp"
+#include "Partitions.hpp"
+#include "Rect.hpp"
+
+#include <Eigen/Core>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fort {
+namespace artemis {
+
+// Static mask of the frame regions where tags can appear. Masked regions are
+// excluded from partitioning and detection.
+class DetectionMask {
+public:
+	typedef std::unique_ptr<DetectionMask> Ptr;
+	typedef std::vector<Eigen::Vector2d>   Polygon;
+
+	// resolution of the active area counts.
+	constexpr static int BLOCK_SIZE = 8;
+
+	// spec is either a PNG file whose non-zero pixels are active, or a list
+	// of polygons, separated by ';', of space separated 'x,y' vertices.
+	static Ptr Load(const std::string &spec, const Size &size);
+
+	static std::vector<Polygon> ParsePolygons(const std::string &spec);
+
+	// non-zero pixels of mask are active.
+	DetectionMask(const ImageU8 &mask);
+	// pixels whose center is in any of the polygons are active.
+	DetectionMask(const Size &size, const std::vector<Polygon> &polygons);
+
+	const Size &FrameSize() const;
+
+	bool IsActive(double x, double y) const;
+
+	// Number of active pixels in rect, exact for rectangles aligned on
+	// BLOCK_SIZE.
+	double ActiveArea(const Rect &rect) const;
+
+	// Smallest rectangle aligned on BLOCK_SIZE, clamped to rect, holding all
+	// the active pixels of rect. Its size is zero if there is none.
+	Rect ActiveBounds(const Rect &rect) const;
+
+	// Sets the masked pixels of image, a copy of the frame region roi, to a
+	// uniform value. apriltag does not segment uniform regions.
+	void Apply(ImageU8 &image, const Rect &roi) const;
+
+	// Returns a cost map whose costs are the active areas.
+	CostMap ActiveAreaMap(int cellSize) const;
+
+private:
+	void countBlocks();
+
+	Size                  d_size;
+	std::vector<uint8_t>  d_mask;
+	int                   d_blocksX, d_blocksY;
+	std::vector<uint16_t> d_blockCounts;
+};
+
+} // namespace artemis
+} // namespace fort
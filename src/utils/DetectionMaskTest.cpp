@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include "DetectionMask.hpp"
+
+namespace fort {
+namespace artemis {
+
+class DetectionMaskTest : public ::testing::Test {};
+
+TEST_F(DetectionMaskTest, ParsesPolygons) {
+	auto polygons =
+	    DetectionMask::ParsePolygons("0,0 10,0 10,10; 20.5,20 30,20 30,30 ;");
+	ASSERT_EQ(polygons.size(), 2);
+	ASSERT_EQ(polygons[0].size(), 3);
+	ASSERT_EQ(polygons[1].size(), 3);
+	EXPECT_DOUBLE_EQ(polygons[0][1].x(), 10.0);
+	EXPECT_DOUBLE_EQ(polygons[1][0].x(), 20.5);
+	EXPECT_DOUBLE_EQ(polygons[1][2].y(), 30.0);
+
+	EXPECT_THROW(DetectionMask::ParsePolygons(""), std::invalid_argument);
+	EXPECT_THROW(
+	    DetectionMask::ParsePolygons("0,0 10,0"),
+	    std::invalid_argument
+	);
+	EXPECT_THROW(
+	    DetectionMask::ParsePolygons("0,0 10;0 10,10"),
+	    std::invalid_argument
+	);
+	EXPECT_THROW(
+	    DetectionMask::ParsePolygons("0,0 10,0a 10,10"),
+	    std::invalid_argument
+	);
+}
+
+TEST_F(DetectionMaskTest, RasterizesPolygons) {
+	// a square and a triangle.
+	DetectionMask mask{
+	    {64, 48},
+	    DetectionMask::ParsePolygons(
+	        "8,8 24,8 24,24 8,24; 40,40 60,40 60,20"
+	    ),
+	};
+
+	EXPECT_TRUE(mask.IsActive(8, 8));
+	EXPECT_TRUE(mask.IsActive(23.9, 23.9));
+	EXPECT_FALSE(mask.IsActive(24, 16));
+	EXPECT_FALSE(mask.IsActive(7.9, 16));
+	EXPECT_TRUE(mask.IsActive(59, 39));
+	EXPECT_FALSE(mask.IsActive(41, 21));
+	EXPECT_FALSE(mask.IsActive(-1, 0));
+	EXPECT_FALSE(mask.IsActive(64, 0));
+
+	EXPECT_DOUBLE_EQ(mask.ActiveArea(Rect({8, 8}, {16, 16})), 256.0);
+	EXPECT_DOUBLE_EQ(mask.ActiveArea(Rect({0, 0}, {32, 32})), 256.0);
+	// a triangle half of a 20x20 square, with its diagonal pixels.
+	EXPECT_DOUBLE_EQ(mask.ActiveArea(Rect({40, 16}, {24, 32})), 210.0);
+
+	EXPECT_EQ(
+	    mask.ActiveBounds(Rect({0, 0}, {32, 48})),
+	    Rect({8, 8}, {16, 16})
+	);
+	EXPECT_EQ(
+	    mask.ActiveBounds(Rect({12, 0}, {40, 48})),
+	    Rect({12, 8}, {40, 32})
+	);
+	EXPECT_EQ(mask.ActiveBounds(Rect({0, 32}, {32, 16})).Size(), Size(0, 0));
+}
+
+TEST_F(DetectionMaskTest, FillsMaskedPixels) {
+	std::vector<uint8_t> maskData(32 * 16, 0);
+	for (int y = 4; y < 12; ++y) {
+		for (int x = 10; x < 20; ++x) {
+			maskData[y * 32 + x] = 1;
+		}
+	}
+	DetectionMask mask{ImageU8{32, 16, maskData.data(), 32}};
+	EXPECT_DOUBLE_EQ(mask.ActiveArea(Rect({0, 0}, {32, 16})), 80.0);
+
+	std::vector<uint8_t> data(64 * 8, 200);
+	ImageU8              image{16, 8, data.data(), 64};
+	mask.Apply(image, Rect({8, 2}, {16, 8}));
+	for (int y = 0; y < 8; ++y) {
+		for (int x = 0; x < 16; ++x) {
+			bool active = y + 2 >= 4 && x + 8 >= 10 && x + 8 < 20;
+			EXPECT_EQ(data[y * 64 + x], active ? 200 : 0)
+			    << "x: " << x << " y: " << y;
+		}
+		// outside of image
+		EXPECT_EQ(data[y * 64 + 16], 200);
+	}
+
+	auto costs = mask.ActiveAreaMap(16);
+	EXPECT_FALSE(costs.Empty());
+	EXPECT_DOUBLE_EQ(costs.Cost(Rect({0, 0}, {16, 16})), 48.0);
+	EXPECT_DOUBLE_EQ(costs.Cost(Rect({16, 0}, {16, 16})), 32.0);
+}
+
+TEST_F(DetectionMaskTest, MasksAdaptivePartitions) {
+	// only the left half of the frame is active.
+	DetectionMask mask{
+	    {96, 48},
+	    DetectionMask::ParsePolygons("0,0 48,0 48,48 0,48"),
+	};
+	CostMap costs{{96, 48}, 16, 1.0};
+
+	// partitions are recorded once shrunk to their active bounds.
+	const auto recordFrame = [&]() {
+		for (const auto &tile : Partition{
+		         Rect({0, 0}, {48, 48}),
+		         Rect({48, 0}, {48, 48}),
+		     }) {
+			const auto active = mask.ActiveBounds(tile);
+			if (active.width() > 0 && active.height() > 0) {
+				costs.Record(active, 1.0);
+			}
+		}
+		costs.Update();
+	};
+
+	recordFrame();
+	EXPECT_TRUE(costs.Empty());
+
+	costs.MarkEmptyCells(mask.ActiveAreaMap(16));
+	recordFrame();
+	EXPECT_FALSE(costs.Empty());
+	EXPECT_DOUBLE_EQ(costs.Cost(Rect({0, 0}, {96, 48})), 1.0);
+	EXPECT_DOUBLE_EQ(costs.Cost(Rect({48, 0}, {48, 48})), 0.0);
+
+	EXPECT_THROW(
+	    costs.MarkEmptyCells(mask.ActiveAreaMap(8)),
+	    std::invalid_argument
+	);
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,57 @@
+#include "DetectionMerger.hpp"
+
+#include <algorithm>
+
+namespace fort {
+namespace artemis {
+
+DetectionMerger::DetectionMerger(double minimumDistance)
+    : d_minimumDistanceSquared{minimumDistance * minimumDistance} {}
+
+const DetectionMerger::List &
+DetectionMerger::Merge(const std::vector<List> &lists) {
+	d_all.clear();
+	for (const auto &l : lists) {
+		d_all.insert(d_all.end(), l.begin(), l.end());
+	}
+
+	d_order.resize(d_all.size());
+	for (size_t i = 0; i < d_order.size(); ++i) {
+		d_order[i] = i;
+	}
+	// duplicates are next to each other, in order of appearance.
+	std::sort(d_order.begin(), d_order.end(), [this](uint32_t a, uint32_t b) {
+		return d_all[a].ID < d_all[b].ID ||
+		       (d_all[a].ID == d_all[b].ID && a < b);
+	});
+
+	d_kept.assign(d_all.size(), false);
+	for (size_t begin = 0, end = 0; begin < d_order.size(); begin = end) {
+		const uint32_t ID = d_all[d_order[begin]].ID;
+		for (end = begin; end < d_order.size() && d_all[d_order[end]].ID == ID;
+		     ++end) {
+			const auto &d         = d_all[d_order[end]];
+			bool        duplicate = false;
+			for (size_t k = begin; k < end && duplicate == false; ++k) {
+				if (d_kept[d_order[k]] == false) {
+					continue;
+				}
+				const auto &p  = d_all[d_order[k]];
+				double      dx = d.X - p.X, dy = d.Y - p.Y;
+				duplicate      = dx * dx + dy * dy < d_minimumDistanceSquared;
+			}
+			d_kept[d_order[end]] = !duplicate;
+		}
+	}
+
+	d_result.clear();
+	for (size_t i = 0; i < d_all.size(); ++i) {
+		if (d_kept[i] == true) {
+			d_result.push_back(d_all[i]);
+		}
+	}
+	return d_result;
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace fort {
+namespace artemis {
+
+// Removes the duplicated detections of overlapping partitions. All buffers
+// are kept between calls, so once they reach their capacity, merging does
+// not allocate.
+class DetectionMerger {
+public:
+	struct Detection {
+		uint32_t ID;
+		double   X, Y, Theta;
+		// in the order of apriltag_detection_t::p.
+		double Corners[4][2];
+	};
+
+	typedef std::vector<Detection> List;
+
+	DetectionMerger(double minimumDistance);
+
+	// Returns the detections of all lists, without the ones closer than the
+	// minimum distance to a previous detection of the same ID. Detections
+	// keep their order. The result is valid until the next call.
+	const List &Merge(const std::vector<List> &lists);
+
+private:
+	double                d_minimumDistanceSquared;
+	List                  d_all, d_result;
+	std::vector<uint32_t> d_order;
+	std::vector<bool>     d_kept;
+};
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include "DetectionMerger.hpp"
+
+namespace fort {
+namespace artemis {
+
+class DetectionMergerTest : public ::testing::Test {};
+
+TEST_F(DetectionMergerTest, RemovesCloseDuplicates) {
+	DetectionMerger merger{5.0};
+
+	std::vector<DetectionMerger::List> lists = {
+	    {
+	        {.ID = 3, .X = 10.0, .Y = 10.0, .Theta = 0.1},
+	        {.ID = 1, .X = 100.0, .Y = 100.0, .Theta = 0.2},
+	    },
+	    {},
+	    {
+	        // duplicate of the first one
+	        {.ID = 3, .X = 12.0, .Y = 11.0, .Theta = 0.3},
+	        // same ID, but far away
+	        {.ID = 3, .X = 200.0, .Y = 10.0, .Theta = 0.4},
+	        {.ID = 2, .X = 10.0, .Y = 10.0, .Theta = 0.5},
+	    },
+	    {
+	        {.ID = 3, .X = 203.0, .Y = 10.0, .Theta = 0.6},
+	        {.ID = 1, .X = 105.0, .Y = 100.0, .Theta = 0.7},
+	    },
+	};
+
+	std::vector<double> expected = {0.1, 0.2, 0.4, 0.5, 0.7};
+
+	for (int i = 0; i < 2; ++i) {
+		const auto &res = merger.Merge(lists);
+		ASSERT_EQ(res.size(), expected.size());
+		for (size_t j = 0; j < expected.size(); ++j) {
+			EXPECT_DOUBLE_EQ(res[j].Theta, expected[j]);
+		}
+	}
+
+	EXPECT_TRUE(merger.Merge({}).empty());
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,317 @@
+#include "ImageKernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ARTEMIS_HAS_X86_KERNELS 1
+#endif
+
+namespace fort {
+namespace artemis {
+
+GaussianKernel GaussianKernel::ForQuadSigma(float quadSigma) {
+	// same computation than apriltag_detector_detect(), negative values
+	// sharpen the image instead.
+	if (quadSigma <= 0.0f) {
+		return {};
+	}
+	float sigma = std::fabs(quadSigma);
+	int   ksz   = 4 * sigma;
+	if ((ksz & 1) == 0) {
+		ksz++;
+	}
+	if (ksz <= 1) {
+		return {};
+	}
+
+	// same computation than image_u8_gaussian_blur().
+	std::vector<double> dk(ksz);
+	double              acc = 0;
+	for (int i = 0; i < ksz; i++) {
+		double x = -ksz / 2 + i;
+		dk[i]    = std::exp(-.5 * (x / sigma) * (x / sigma));
+		acc += dk[i];
+	}
+	GaussianKernel res;
+	res.Weights.resize(ksz);
+	for (int i = 0; i < ksz; i++) {
+		res.Weights[i] = (dk[i] / acc) * 255;
+	}
+	return res;
+}
+
+namespace {
+
+// Rows are blurred in a ring buffer of ksz rows, from which the columns are
+// blurred into dst. The edges follow apriltag's convolve(): the first ksz/2
+// and the last ksz/2+1 pixels are not convolved.
+class SeparableBlur {
+public:
+	SeparableBlur(
+	    ImageU8 &dst, const ImageU8 &src, const GaussianKernel &kernel
+	)
+	    : d_dst{dst}
+	    , d_src{src}
+	    , d_k{kernel.Weights.data()}
+	    , d_ksz{int(kernel.Weights.size())}
+	    , d_stride{(src.width + 31) & ~31} {
+		if (dst.width != src.width || dst.height != src.height) {
+			throw std::invalid_argument("Sizes must match");
+		}
+		thread_local std::vector<uint8_t>         ring;
+		thread_local std::vector<const uint8_t *> rows;
+		ring.resize(d_stride * d_ksz);
+		rows.resize(d_ksz);
+		d_ring = ring.data();
+		d_rows = rows.data();
+	}
+
+	template <typename RowFunction, typename ColumnFunction>
+	void Run(RowFunction blurRow, ColumnFunction blurColumns) {
+		const int w = d_src.width, h = d_src.height, half = d_ksz / 2;
+		if (w < d_ksz || h < d_ksz) {
+			// apriltag would read out of bounds, we leave it unblurred.
+			ImageU8::Copy(d_dst, d_src);
+			return;
+		}
+
+		for (int r = 0; r < h; ++r) {
+			uint8_t       *row = ringRow(r);
+			const uint8_t *in  = d_src.buffer + r * d_src.stride;
+			memcpy(row, in, half);
+			blurRow(row + half, in, w - d_ksz, d_k, d_ksz);
+			memcpy(row + w - half - 1, in + w - half - 1, half + 1);
+
+			if (r < half || r >= h - half - 1) {
+				memcpy(d_dst.buffer + r * d_dst.stride, row, w);
+			}
+			// row r completes the window of output row r - half, but the
+			// last row is never part of a convolved window.
+			if (r >= d_ksz - 1 && r < h - 1) {
+				for (int j = 0; j < d_ksz; ++j) {
+					d_rows[j] = ringRow(r - d_ksz + 1 + j);
+				}
+				blurColumns(
+				    d_dst.buffer + (r - half) * d_dst.stride,
+				    d_rows,
+				    w,
+				    d_k,
+				    d_ksz
+				);
+			}
+		}
+	}
+
+private:
+	uint8_t *ringRow(int r) {
+		return d_ring + (r % d_ksz) * d_stride;
+	}
+
+	ImageU8        &d_dst;
+	const ImageU8  &d_src;
+	const uint8_t  *d_k;
+	int             d_ksz;
+	int             d_stride;
+	uint8_t        *d_ring;
+	const uint8_t **d_rows;
+};
+
+// out[i] = sum_j k[j] * in[i + j] >> 8 for i in [0, n).
+void blurRowScalar(
+    uint8_t *out, const uint8_t *in, int n, const uint8_t *k, int ksz
+) {
+	for (int i = 0; i < n; ++i) {
+		uint32_t acc = 0;
+		for (int j = 0; j < ksz; ++j) {
+			acc += k[j] * in[i + j];
+		}
+		out[i] = acc >> 8;
+	}
+}
+
+void blurColumnsScalar(
+    uint8_t *out, const uint8_t **rows, int width, const uint8_t *k, int ksz
+) {
+	for (int x = 0; x < width; ++x) {
+		uint32_t acc = 0;
+		for (int j = 0; j < ksz; ++j) {
+			acc += k[j] * rows[j][x];
+		}
+		out[x] = acc >> 8;
+	}
+}
+
+#ifdef ARTEMIS_HAS_X86_KERNELS
+// The kernel weights sum to at most 255, so accumulating 8 bit pixels in
+// 16 bit lanes never overflows.
+// Horizontal sums read src[0] shifted by j, vertical ones read src[j].
+__attribute__((target("avx2"))) inline __m128i accumulate16(
+    const uint8_t *const *src,
+    size_t                offset,
+    const uint8_t        *k,
+    int                   ksz,
+    bool                  horizontal
+) {
+	__m256i acc = _mm256_setzero_si256();
+	for (int j = 0; j < ksz; ++j) {
+		const uint8_t *p = horizontal ? src[0] + offset + j : src[j] + offset;
+		__m256i        v = _mm256_cvtepu8_epi16(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p))
+        );
+		acc = _mm256_add_epi16(
+		    acc,
+		    _mm256_mullo_epi16(v, _mm256_set1_epi16(k[j]))
+		);
+	}
+	acc = _mm256_srli_epi16(acc, 8);
+	return _mm_packus_epi16(
+	    _mm256_castsi256_si128(acc),
+	    _mm256_extracti128_si256(acc, 1)
+	);
+}
+
+__attribute__((target("avx2"))) void blurRowAVX2(
+    uint8_t *out, const uint8_t *in, int n, const uint8_t *k, int ksz
+) {
+	int i = 0;
+	for (; i + 16 <= n; i += 16) {
+		_mm_storeu_si128(
+		    reinterpret_cast<__m128i *>(out + i),
+		    accumulate16(&in, i, k, ksz, true)
+		);
+	}
+	blurRowScalar(out + i, in + i, n - i, k, ksz);
+}
+
+__attribute__((target("avx2"))) void blurColumnsAVX2(
+    uint8_t *out, const uint8_t **rows, int width, const uint8_t *k, int ksz
+) {
+	int x = 0;
+	for (; x + 16 <= width; x += 16) {
+		_mm_storeu_si128(
+		    reinterpret_cast<__m128i *>(out + x),
+		    accumulate16(rows, x, k, ksz, false)
+		);
+	}
+	for (; x < width; ++x) {
+		uint32_t acc = 0;
+		for (int j = 0; j < ksz; ++j) {
+			acc += k[j] * rows[j][x];
+		}
+		out[x] = acc >> 8;
+	}
+}
+
+bool hasAVX2() {
+	static bool res = __builtin_cpu_supports("avx2");
+	return res;
+}
+#endif
+
+} // namespace
+
+void CopyAndBlurScalar(
+    ImageU8 &dst, const ImageU8 &src, const GaussianKernel &kernel
+) {
+	if (kernel.Empty()) {
+		ImageU8::Copy(dst, src);
+		return;
+	}
+	SeparableBlur{dst, src, kernel}.Run(blurRowScalar, blurColumnsScalar);
+}
+
+void CopyAndBlur(
+    ImageU8 &dst, const ImageU8 &src, const GaussianKernel &kernel
+) {
+#ifdef ARTEMIS_HAS_X86_KERNELS
+	if (kernel.Empty() == false && hasAVX2()) {
+		SeparableBlur{dst, src, kernel}.Run(blurRowAVX2, blurColumnsAVX2);
+		return;
+	}
+#endif
+	CopyAndBlurScalar(dst, src, kernel);
+}
+
+namespace {
+
+// If dst is not null, rows are copied to it while summed.
+void blockMeans(
+    ImageU8 *dst, const ImageU8 &src, std::vector<uint8_t> &means
+) {
+	const int blocksX = (src.width + 7) / 8, blocksY = (src.height + 7) / 8;
+	means.resize(blocksX * blocksY);
+
+	thread_local std::vector<uint32_t> sums;
+	for (int by = 0; by < blocksY; ++by) {
+		sums.assign(blocksX, 0);
+		const int rows = std::min(8, src.height - 8 * by);
+		for (int r = 0; r < rows; ++r) {
+			const int      y   = 8 * by + r;
+			const uint8_t *in  = src.buffer + y * src.stride;
+			uint8_t       *out = nullptr;
+			if (dst != nullptr) {
+				out = dst->buffer + y * dst->stride;
+			}
+			int x = 0;
+#ifdef ARTEMIS_HAS_X86_KERNELS
+			// SSE2 is part of x86_64, no need to check for it.
+			const __m128i zero = _mm_setzero_si128();
+			for (; x + 16 <= src.width; x += 16) {
+				__m128i v =
+				    _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x));
+				if (out != nullptr) {
+					_mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), v);
+				}
+				__m128i sad = _mm_sad_epu8(v, zero);
+				sums[x / 8] += _mm_cvtsi128_si32(sad);
+				sums[x / 8 + 1] += _mm_extract_epi16(sad, 4);
+			}
+#endif
+			for (; x < src.width; ++x) {
+				sums[x / 8] += in[x];
+				if (out != nullptr) {
+					out[x] = in[x];
+				}
+			}
+		}
+		for (int bx = 0; bx < blocksX; ++bx) {
+			const int cols = std::min(8, src.width - 8 * bx);
+			means[by * blocksX + bx] = sums[bx] / (rows * cols);
+		}
+	}
+}
+
+} // namespace
+
+void BlockMeans(const ImageU8 &src, std::vector<uint8_t> &means) {
+	blockMeans(nullptr, src, means);
+}
+
+void CopyAndBlockMeans(
+    ImageU8 &dst, const ImageU8 &src, std::vector<uint8_t> &means
+) {
+	if (dst.width != src.width || dst.height != src.height) {
+		throw std::invalid_argument("Sizes must match");
+	}
+	blockMeans(&dst, src, means);
+}
+
+uint8_t MaxAbsDifference(
+    const std::vector<uint8_t> &a, const std::vector<uint8_t> &b
+) {
+	if (a.size() != b.size()) {
+		return 255;
+	}
+	uint8_t res = 0;
+	for (size_t i = 0; i < a.size(); ++i) {
+		res = std::max(res, uint8_t(a[i] > b[i] ? a[i] - b[i] : b[i] - a[i]));
+	}
+	return res;
+}
+
+} // namespace artemis
+} // namespace fort
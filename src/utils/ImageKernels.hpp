@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ImageU8.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace fort {
+namespace artemis {
+
+// Integer kernel of apriltag's image_u8_gaussian_blur().
+struct GaussianKernel {
+	std::vector<uint8_t> Weights;
+
+	// Returns the kernel apriltag_detector_detect() uses for quad_sigma, or
+	// an empty one if it does not blur.
+	static GaussianKernel ForQuadSigma(float quadSigma);
+
+	bool Empty() const {
+		return Weights.empty();
+	}
+};
+
+// Copies src into dst, blurred exactly like image_u8_gaussian_blur() would
+// blur dst in place. Uses AVX2 if the CPU supports it. Only the quad_sigma
+// blur is done here: the adaptive threshold stays in apriltag_quad_thresh(),
+// which cannot be given a thresholded image.
+void CopyAndBlur(
+    ImageU8 &dst, const ImageU8 &src, const GaussianKernel &kernel
+);
+
+// Scalar version of CopyAndBlur(), always available.
+void CopyAndBlurScalar(
+    ImageU8 &dst, const ImageU8 &src, const GaussianKernel &kernel
+);
+
+// Computes the mean of each 8x8 block of src, in row major order. Blocks on
+// the right and bottom borders may be smaller.
+void BlockMeans(const ImageU8 &src, std::vector<uint8_t> &means);
+
+// Does ImageU8::Copy() and BlockMeans() in a single pass over src.
+void CopyAndBlockMeans(
+    ImageU8 &dst, const ImageU8 &src, std::vector<uint8_t> &means
+);
+
+// Returns the largest absolute difference between a and b, or 255 if their
+// sizes differ.
+uint8_t MaxAbsDifference(
+    const std::vector<uint8_t> &a, const std::vector<uint8_t> &b
+);
+
+} // namespace artemis
+} // namespace fort
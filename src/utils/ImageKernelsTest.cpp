@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+
+#include "ImageKernels.hpp"
+
+#include <apriltag/common/image_u8.h>
+
+#include <cmath>
+#include <random>
+
+namespace fort {
+namespace artemis {
+
+class ImageKernelsTest : public ::testing::Test {};
+
+TEST_F(ImageKernelsTest, BlurMatchesApriltag) {
+	std::mt19937 rng{42};
+
+	struct TestData {
+		float QuadSigma;
+		int   Width, Height;
+	};
+
+	std::vector<TestData> testdata = {
+	    {0.8, 100, 80},
+	    {1.0, 37, 53},
+	    {1.6, 257, 19},
+	    {2.0, 64, 64},
+	    {3.7, 131, 77},
+	};
+
+	for (const auto &d : testdata) {
+		std::vector<uint8_t> srcData(512 * 512);
+		for (auto &v : srcData) {
+			v = rng();
+		}
+		// a ROI, so src stride is different than dst one.
+		ImageU8 src{d.Width, d.Height, srcData.data() + 513, 512};
+
+		auto expected = image_u8_create(d.Width, d.Height);
+		for (int y = 0; y < d.Height; ++y) {
+			memcpy(
+			    expected->buf + y * expected->stride,
+			    src.buffer + y * src.stride,
+			    d.Width
+			);
+		}
+		float sigma = std::fabs(d.QuadSigma);
+		int   ksz   = 4 * sigma;
+		if ((ksz & 1) == 0) {
+			ksz++;
+		}
+		image_u8_gaussian_blur(expected, sigma, ksz);
+
+		auto kernel = GaussianKernel::ForQuadSigma(d.QuadSigma);
+		ASSERT_FALSE(kernel.Empty());
+
+		std::vector<uint8_t> data(2 * ((d.Width + 63) & ~63) * d.Height);
+		ImageU8              res{d.Width, d.Height, data.data()};
+		ImageU8              scalar{
+            d.Width,
+            d.Height,
+            data.data() + data.size() / 2
+        };
+		CopyAndBlur(res, src, kernel);
+		CopyAndBlurScalar(scalar, src, kernel);
+
+		for (int y = 0; y < d.Height; ++y) {
+			for (int x = 0; x < d.Width; ++x) {
+				const auto e = expected->buf[y * expected->stride + x];
+				ASSERT_EQ(res.at(x, y), e)
+				    << "sigma: " << d.QuadSigma << " x: " << x << " y: " << y;
+				ASSERT_EQ(scalar.at(x, y), e)
+				    << "sigma: " << d.QuadSigma << " x: " << x << " y: " << y;
+			}
+		}
+		image_u8_destroy(expected);
+	}
+}
+
+TEST_F(ImageKernelsTest, NoBlurForSmallSigma) {
+	EXPECT_TRUE(GaussianKernel::ForQuadSigma(0.0).Empty());
+	EXPECT_TRUE(GaussianKernel::ForQuadSigma(0.4).Empty());
+	// apriltag sharpens for negative values.
+	EXPECT_TRUE(GaussianKernel::ForQuadSigma(-0.8).Empty());
+	EXPECT_EQ(GaussianKernel::ForQuadSigma(0.8).Weights.size(), 3);
+}
+
+TEST_F(ImageKernelsTest, BlockMeans) {
+	std::mt19937         rng{42};
+	std::vector<uint8_t> srcData(512 * 100);
+	for (auto &v : srcData) {
+		v = rng();
+	}
+	// a ROI with partial blocks on the borders.
+	ImageU8 src{181, 45, srcData.data() + 3, 512};
+
+	std::vector<uint8_t> expected;
+	for (int by = 0; by < 6; ++by) {
+		for (int bx = 0; bx < 23; ++bx) {
+			uint32_t sum{0}, count{0};
+			for (int y = 8 * by; y < std::min(8 * by + 8, 45); ++y) {
+				for (int x = 8 * bx; x < std::min(8 * bx + 8, 181); ++x) {
+					sum += src.at(x, y);
+					++count;
+				}
+			}
+			expected.push_back(sum / count);
+		}
+	}
+
+	std::vector<uint8_t> means, copyMeans;
+	std::vector<uint8_t> data(192 * 45);
+	ImageU8              dst{181, 45, data.data()};
+	BlockMeans(src, means);
+	CopyAndBlockMeans(dst, src, copyMeans);
+
+	EXPECT_EQ(means, expected);
+	EXPECT_EQ(copyMeans, expected);
+	EXPECT_EQ(MaxAbsDifference(means, copyMeans), 0);
+	for (int y = 0; y < 45; ++y) {
+		for (int x = 0; x < 181; ++x) {
+			ASSERT_EQ(dst.at(x, y), src.at(x, y));
+		}
+	}
+
+	copyMeans[4] += 7;
+	EXPECT_EQ(MaxAbsDifference(means, copyMeans), 7);
+	copyMeans.pop_back();
+	EXPECT_EQ(MaxAbsDifference(means, copyMeans), 255);
+}
+
+} // namespace artemis
+} // namespace fort
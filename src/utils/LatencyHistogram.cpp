@@ -0,0 +1,116 @@
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace fort {
+namespace artemis {
+
+size_t LatencyHistogram::BucketIndex(uint64_t valueUS) {
+	valueUS = std::min(valueUS, MAX_VALUE_US);
+	// the position of the highest bit is the magnitude, and the next
+	// SUB_BUCKET_BITS - 1 bits select the sub-bucket.
+	const int    msb   = std::bit_width(valueUS) - 1;
+	const size_t shift = std::max(msb - int(SUB_BUCKET_BITS - 1), 0);
+	return shift * HALF_BUCKETS + (valueUS >> shift);
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+	if (index < 2 * HALF_BUCKETS) {
+		return index;
+	}
+	const size_t shift    = index / HALF_BUCKETS - 1;
+	const size_t mantissa = index - shift * HALF_BUCKETS;
+	return ((uint64_t(mantissa) + 1) << shift) - 1;
+}
+
+LatencyHistogram::LatencyHistogram() {
+	for (auto &c : d_counts) {
+		c.store(0, std::memory_order_relaxed);
+	}
+}
+
+void LatencyHistogram::Record(const Duration &duration) {
+	const int64_t  ns = duration.Nanoseconds();
+	const uint64_t us = ns > 0 ? ns / 1000 : 0;
+	d_counts[BucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+	d_sumUS.fetch_add(us, std::memory_order_relaxed);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Read() const {
+	Snapshot res;
+	res.d_counts.resize(BUCKETS);
+	res.d_sumUS = d_sumUS.load(std::memory_order_relaxed);
+	for (size_t i = 0; i < BUCKETS; ++i) {
+		res.d_counts[i] = d_counts[i].load(std::memory_order_relaxed);
+		res.d_count += res.d_counts[i];
+	}
+	return res;
+}
+
+uint64_t LatencyHistogram::Snapshot::Count() const {
+	return d_count;
+}
+
+Duration LatencyHistogram::Snapshot::Sum() const {
+	return int64_t(d_sumUS) * Duration::Microsecond;
+}
+
+uint64_t LatencyHistogram::Snapshot::CountBelow(uint64_t valueUS) const {
+	uint64_t res{0};
+	for (size_t i = 0; i < d_counts.size(); ++i) {
+		if (BucketUpperBound(i) > valueUS) {
+			break;
+		}
+		res += d_counts[i];
+	}
+	return res;
+}
+
+LatencyHistogram::Snapshot
+LatencyHistogram::Snapshot::Since(const Snapshot &previous) const {
+	if (previous.d_counts.size() != d_counts.size()) {
+		return *this;
+	}
+	Snapshot res;
+	res.d_counts.resize(d_counts.size());
+	// sums may be read a bit ahead of the counts, and never go backward.
+	res.d_sumUS = d_sumUS - std::min(previous.d_sumUS, d_sumUS);
+	for (size_t i = 0; i < d_counts.size(); ++i) {
+		res.d_counts[i] = d_counts[i] - previous.d_counts[i];
+		res.d_count += res.d_counts[i];
+	}
+	return res;
+}
+
+Duration LatencyHistogram::Snapshot::Percentile(double p) const {
+	if (d_count == 0) {
+		return 0;
+	}
+	const uint64_t rank = std::clamp(
+	    uint64_t(std::ceil(p / 100.0 * d_count)),
+	    uint64_t(1),
+	    d_count
+	);
+	uint64_t seen{0};
+	for (size_t i = 0; i < d_counts.size(); ++i) {
+		seen += d_counts[i];
+		if (seen >= rank) {
+			return int64_t(BucketUpperBound(i)) * Duration::Microsecond;
+		}
+	}
+	return Max();
+}
+
+Duration LatencyHistogram::Snapshot::Max() const {
+	for (size_t i = d_counts.size(); i > 0; --i) {
+		if (d_counts[i - 1] > 0) {
+			return int64_t(BucketUpperBound(i - 1)) * Duration::Microsecond;
+		}
+	}
+	return 0;
+}
+
+} // namespace artemis
+} // namespace fort
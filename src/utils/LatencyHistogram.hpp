@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <fort/time/Time.hpp>
+
+namespace fort {
+namespace artemis {
+
+// Lock-free histogram of durations, with buckets growing like floating point
+// numbers, as in HDR histograms: values up to 128us are exact, and larger
+// ones are within 1/64 of their value, up to more than a day. Recording is
+// wait-free and can be done from any thread.
+class LatencyHistogram {
+public:
+	// values below 2^SUB_BUCKET_BITS us have their own bucket, and each
+	// following power of two is split in HALF_BUCKETS.
+	constexpr static size_t SUB_BUCKET_BITS = 7;
+	constexpr static size_t MAGNITUDES      = 30;
+	constexpr static size_t HALF_BUCKETS = size_t(1) << (SUB_BUCKET_BITS - 1);
+	constexpr static size_t BUCKETS      = HALF_BUCKETS * (MAGNITUDES + 2);
+	constexpr static uint64_t MAX_VALUE_US =
+	    (uint64_t(1) << (SUB_BUCKET_BITS + MAGNITUDES)) - 1;
+
+	// Counts of a histogram at a given time.
+	class Snapshot {
+	public:
+		uint64_t Count() const;
+		// Returns the sum of the recorded values.
+		Duration Sum() const;
+		// Returns the number of values in the buckets whose upper bound is
+		// at most valueUS.
+		uint64_t CountBelow(uint64_t valueUS) const;
+		// Returns the p-th percentile, as the upper bound of its bucket.
+		Duration Percentile(double p) const;
+		Duration Max() const;
+
+		// Returns the values recorded between previous and this snapshot.
+		Snapshot Since(const Snapshot &previous) const;
+
+	private:
+		friend class LatencyHistogram;
+
+		std::vector<uint64_t> d_counts;
+		uint64_t              d_count = 0, d_sumUS = 0;
+	};
+
+	// Returns the bucket of value, values above MAX_VALUE_US are clamped.
+	static size_t BucketIndex(uint64_t valueUS);
+	// Returns the largest value of bucket index.
+	static uint64_t BucketUpperBound(size_t index);
+
+	LatencyHistogram();
+
+	void Record(const Duration &duration);
+
+	// Returns the counts recorded so far. Values recorded concurrently are
+	// either in this snapshot or the next.
+	Snapshot Read() const;
+
+private:
+	std::array<std::atomic<uint64_t>, BUCKETS> d_counts;
+	std::atomic<uint64_t>                      d_sumUS{0};
+};
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "LatencyHistogram.hpp"
+
+namespace fort {
+namespace artemis {
+
+class LatencyHistogramTest : public ::testing::Test {};
+
+TEST_F(LatencyHistogramTest, BucketsAreContiguousAndPrecise) {
+	size_t last = 0;
+	for (uint64_t v = 0; v < 1000000; v += 1 + v / 1000) {
+		const auto index = LatencyHistogram::BucketIndex(v);
+		ASSERT_GE(index, last) << "value " << v;
+		ASSERT_LT(index, LatencyHistogram::BUCKETS);
+		last             = index;
+		const auto upper = LatencyHistogram::BucketUpperBound(index);
+		ASSERT_GE(upper, v);
+		ASSERT_LE(upper - v, v / 64) << "value " << v;
+		ASSERT_EQ(LatencyHistogram::BucketIndex(upper), index);
+	}
+	EXPECT_EQ(
+	    LatencyHistogram::BucketIndex(LatencyHistogram::MAX_VALUE_US),
+	    LatencyHistogram::BUCKETS - 1
+	);
+	EXPECT_EQ(
+	    LatencyHistogram::BucketIndex(~uint64_t(0)),
+	    LatencyHistogram::BUCKETS - 1
+	);
+}
+
+TEST_F(LatencyHistogramTest, ComputesPercentiles) {
+	LatencyHistogram histogram;
+	for (int64_t i = 1; i <= 1000; ++i) {
+		histogram.Record(i * Duration::Microsecond);
+	}
+	histogram.Record(-Duration::Second);
+
+	auto snapshot = histogram.Read();
+	EXPECT_EQ(snapshot.Count(), 1001);
+	EXPECT_NEAR(snapshot.Percentile(50).Microseconds(), 500, 500 / 64);
+	EXPECT_NEAR(snapshot.Percentile(99).Microseconds(), 990, 990 / 64);
+	EXPECT_NEAR(snapshot.Max().Microseconds(), 1000, 1000 / 64);
+	EXPECT_EQ(snapshot.Percentile(0).Microseconds(), 0);
+	EXPECT_EQ(snapshot.Sum().Microseconds(), 500500);
+	EXPECT_EQ(snapshot.CountBelow(100), 101);
+	EXPECT_EQ(snapshot.CountBelow(LatencyHistogram::MAX_VALUE_US), 1001);
+
+	// nothing was recorded since the snapshot.
+	auto since = histogram.Read().Since(snapshot);
+	EXPECT_EQ(since.Count(), 0);
+	EXPECT_EQ(since.Percentile(50).Nanoseconds(), 0);
+
+	histogram.Record(2 * Duration::Millisecond);
+	since = histogram.Read().Since(snapshot);
+	EXPECT_EQ(since.Count(), 1);
+	EXPECT_NEAR(since.Max().Microseconds(), 2000, 2000 / 64);
+	EXPECT_EQ(since.Sum().Microseconds(), 2000);
+}
+
+TEST_F(LatencyHistogramTest, RecordsConcurrently) {
+	LatencyHistogram         histogram;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([&histogram, t]() {
+			for (int64_t i = 0; i < 10000; ++i) {
+				histogram.Record((t * 1000 + i % 100) * Duration::Microsecond);
+			}
+		});
+	}
+	for (auto &t : threads) {
+		t.join();
+	}
+	EXPECT_EQ(histogram.Read().Count(), 40000);
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,223 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace fort {
+namespace artemis {
+
+namespace details {
+bool IsValidMetricName(const std::string &name) {
+	if (name.empty() || std::isdigit(uint8_t(name[0]))) {
+		return false;
+	}
+	return std::all_of(name.begin(), name.end(), [](char c) {
+		return std::isalnum(uint8_t(c)) || c == '_' || c == ':';
+	});
+}
+
+std::string FormatMetricValue(double value) {
+	if (std::isnan(value)) {
+		return "NaN";
+	}
+	if (std::isinf(value)) {
+		return value > 0 ? "+Inf" : "-Inf";
+	}
+	// shortest representation, so integral values stay exact.
+	char buffer[32];
+	auto [end, ec] = std::to_chars(buffer, buffer + sizeof(buffer), value);
+	return std::string(buffer, end);
+}
+
+void WriteLabel(
+    std::ostream      &out,
+    char               prefix,
+    const std::string &key,
+    const std::string &value
+) {
+	out << prefix << key << "=\"";
+	for (char c : value) {
+		switch (c) {
+		case '\\':
+			out << "\\\\";
+			break;
+		case '"':
+			out << "\\\"";
+			break;
+		case '\n':
+			out << "\\n";
+			break;
+		default:
+			out << c;
+		}
+	}
+	out << '"';
+}
+
+void WriteLabels(
+    std::ostream          &out,
+    const Metrics::Labels &labels,
+    const std::string     &le = ""
+) {
+	if (labels.empty() && le.empty()) {
+		return;
+	}
+	char prefix = '{';
+	for (const auto &[key, value] : labels) {
+		WriteLabel(out, prefix, key, value);
+		prefix = ',';
+	}
+	if (le.empty() == false) {
+		WriteLabel(out, prefix, "le", le);
+	}
+	out << '}';
+}
+
+const char *TypeName(Metrics::Type type) {
+	switch (type) {
+	case Metrics::Type::Counter:
+		return "counter";
+	case Metrics::Type::Gauge:
+		return "gauge";
+	case Metrics::Type::Histogram:
+		return "histogram";
+	}
+	return "untyped";
+}
+} // namespace details
+
+void Metrics::AddCounter(
+    const std::string &name,
+    const std::string &help,
+    Sampler            sampler,
+    const Labels      &labels
+) {
+	add(name, help, Type::Counter, {.Tags = labels, .Value = sampler});
+}
+
+void Metrics::AddGauge(
+    const std::string &name,
+    const std::string &help,
+    Sampler            sampler,
+    const Labels      &labels
+) {
+	add(name, help, Type::Gauge, {.Tags = labels, .Value = sampler});
+}
+
+void Metrics::AddHistogram(
+    const std::string &name,
+    const std::string &help,
+    HistogramSampler   sampler,
+    const Labels      &labels
+) {
+	add(name, help, Type::Histogram, {.Tags = labels, .Histogram = sampler});
+}
+
+void Metrics::add(
+    const std::string &name,
+    const std::string &help,
+    Type               type,
+    Series           &&series
+) {
+	if (details::IsValidMetricName(name) == false) {
+		throw std::invalid_argument("invalid metric name '" + name + "'");
+	}
+	for (const auto &[key, value] : series.Tags) {
+		if (details::IsValidMetricName(key) == false || key == "le") {
+			throw std::invalid_argument(
+			    "invalid label '" + key + "' for metric '" + name + "'"
+			);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock{d_mutex};
+	auto family = std::find_if(
+	    d_families.begin(),
+	    d_families.end(),
+	    [&name](const Family &f) { return f.Name == name; }
+	);
+	if (family == d_families.end()) {
+		d_families.push_back({.Name = name, .Help = help, .Kind = type});
+		family = d_families.end() - 1;
+	}
+	if (family->Kind != type) {
+		throw std::invalid_argument(
+		    "metric '" + name + "' is already a " +
+		    details::TypeName(family->Kind)
+		);
+	}
+	for (const auto &s : family->Members) {
+		if (s.Tags == series.Tags) {
+			throw std::invalid_argument(
+			    "metric '" + name + "' already has these labels"
+			);
+		}
+	}
+	family->Members.push_back(std::move(series));
+}
+
+void Metrics::Remove(const std::string &name) {
+	std::lock_guard<std::mutex> lock{d_mutex};
+	d_families.erase(
+	    std::remove_if(
+	        d_families.begin(),
+	        d_families.end(),
+	        [&name](const Family &f) { return f.Name == name; }
+	    ),
+	    d_families.end()
+	);
+}
+
+std::string Metrics::Format() const {
+	std::ostringstream out;
+
+	std::lock_guard<std::mutex> lock{d_mutex};
+	for (const auto &family : d_families) {
+		out << "# HELP " << family.Name << " " << family.Help << "\n"
+		    << "# TYPE " << family.Name << " "
+		    << details::TypeName(family.Kind) << "\n";
+
+		for (const auto &series : family.Members) {
+			if (family.Kind != Type::Histogram) {
+				out << family.Name;
+				details::WriteLabels(out, series.Tags);
+				out << " " << details::FormatMetricValue(series.Value())
+				    << "\n";
+				continue;
+			}
+
+			const auto snapshot = series.Histogram();
+			for (const auto bound : HISTOGRAM_BUCKETS_US) {
+				out << family.Name << "_bucket";
+				details::WriteLabels(
+				    out,
+				    series.Tags,
+				    details::FormatMetricValue(bound / 1.0e6)
+				);
+				out << " " << snapshot.CountBelow(bound) << "\n";
+			}
+			out << family.Name << "_bucket";
+			details::WriteLabels(out, series.Tags, "+Inf");
+			out << " " << snapshot.Count() << "\n";
+
+			out << family.Name << "_sum";
+			details::WriteLabels(out, series.Tags);
+			out << " "
+			    << details::FormatMetricValue(snapshot.Sum().Seconds())
+			    << "\n";
+
+			out << family.Name << "_count";
+			details::WriteLabels(out, series.Tags);
+			out << " " << snapshot.Count() << "\n";
+		}
+	}
+
+	return out.str();
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "LatencyHistogram.hpp"
+
+namespace fort {
+namespace artemis {
+
+// Registry of the metrics exposed to Prometheus. Metrics are not stored here:
+// each series is a sampler reading a value the code already maintains, e.g.
+// an atomic counter, only when the metrics are scraped. Therefore updates on
+// the hot path cost no more than they did before.
+class Metrics {
+public:
+	enum class Type {
+		Counter,
+		Gauge,
+		Histogram,
+	};
+
+	typedef std::vector<std::pair<std::string, std::string>> Labels;
+	typedef std::function<double()>                         Sampler;
+	typedef std::function<LatencyHistogram::Snapshot()>     HistogramSampler;
+
+	// Upper bounds of the exported histogram buckets, in microseconds.
+	constexpr static uint64_t HISTOGRAM_BUCKETS_US[] = {
+	    1000,
+	    2500,
+	    5000,
+	    10000,
+	    25000,
+	    50000,
+	    100000,
+	    250000,
+	    500000,
+	    1000000,
+	    2500000,
+	    5000000,
+	    10000000,
+	};
+
+	// Samplers are called from the thread serving the metrics, so they must
+	// be thread-safe. Series of a same name must have the same type and
+	// different labels.
+	void AddCounter(
+	    const std::string &name,
+	    const std::string &help,
+	    Sampler            sampler,
+	    const Labels      &labels = {}
+	);
+
+	void AddGauge(
+	    const std::string &name,
+	    const std::string &help,
+	    Sampler            sampler,
+	    const Labels      &labels = {}
+	);
+
+	// Histograms are exported in seconds.
+	void AddHistogram(
+	    const std::string &name,
+	    const std::string &help,
+	    HistogramSampler   sampler,
+	    const Labels      &labels = {}
+	);
+
+	// Removes all the series of name. Their samplers are not called anymore
+	// once it returns.
+	void Remove(const std::string &name);
+
+	// Samples all series, in the Prometheus text exposition format.
+	std::string Format() const;
+
+private:
+	struct Series {
+		Labels           Tags;
+		Sampler          Value;
+		HistogramSampler Histogram;
+	};
+
+	struct Family {
+		std::string         Name, Help;
+		Type                Kind;
+		std::vector<Series> Members;
+	};
+
+	void add(
+	    const std::string &name,
+	    const std::string &help,
+	    Type               type,
+	    Series           &&series
+	);
+
+	mutable std::mutex  d_mutex;
+	std::vector<Family> d_families;
+};
+
+} // namespace artemis
+} // namespace fort
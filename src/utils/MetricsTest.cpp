@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+
+#include "Metrics.hpp"
+
+namespace fort {
+namespace artemis {
+
+class MetricsTest : public ::testing::Test {};
+
+TEST_F(MetricsTest, FormatsCountersAndGauges) {
+	Metrics             metrics;
+	std::atomic<size_t> processed{0};
+	metrics.AddCounter(
+	    "artemis_frames_total",
+	    "Frames by outcome",
+	    [&processed]() { return processed.load(); },
+	    {{"outcome", "processed"}}
+	);
+	metrics.AddCounter(
+	    "artemis_frames_total",
+	    "Frames by outcome",
+	    []() { return 3; },
+	    {{"outcome", "dropped \"late\""}}
+	);
+	metrics.AddGauge("artemis_queue_depth", "Queued frames", []() {
+		return 2.5;
+	});
+
+	processed = 123456789;
+	EXPECT_EQ(
+	    metrics.Format(),
+	    "# HELP artemis_frames_total Frames by outcome\n"
+	    "# TYPE artemis_frames_total counter\n"
+	    "artemis_frames_total{outcome=\"processed\"} 123456789\n"
+	    "artemis_frames_total{outcome=\"dropped \\\"late\\\"\"} 3\n"
+	    "# HELP artemis_queue_depth Queued frames\n"
+	    "# TYPE artemis_queue_depth gauge\n"
+	    "artemis_queue_depth 2.5\n"
+	);
+
+	metrics.Remove("artemis_frames_total");
+	EXPECT_EQ(
+	    metrics.Format(),
+	    "# HELP artemis_queue_depth Queued frames\n"
+	    "# TYPE artemis_queue_depth gauge\n"
+	    "artemis_queue_depth 2.5\n"
+	);
+}
+
+TEST_F(MetricsTest, FormatsHistograms) {
+	Metrics          metrics;
+	LatencyHistogram histogram;
+	histogram.Record(500 * Duration::Microsecond);
+	histogram.Record(3 * Duration::Millisecond);
+	histogram.Record(20 * Duration::Second);
+	metrics.AddHistogram(
+	    "artemis_latency_seconds",
+	    "Latency",
+	    [&histogram]() { return histogram.Read(); },
+	    {{"stage", "detect"}}
+	);
+
+	const auto formatted = metrics.Format();
+	EXPECT_NE(
+	    formatted.find(
+	        "artemis_latency_seconds_bucket{stage=\"detect\",le=\"0.001\"} 1\n"
+	    ),
+	    std::string::npos
+	) << formatted;
+	EXPECT_NE(
+	    formatted.find(
+	        "artemis_latency_seconds_bucket{stage=\"detect\",le=\"0.005\"} 2\n"
+	    ),
+	    std::string::npos
+	) << formatted;
+	EXPECT_NE(
+	    formatted.find(
+	        "artemis_latency_seconds_bucket{stage=\"detect\",le=\"10\"} 2\n"
+	    ),
+	    std::string::npos
+	) << formatted;
+	EXPECT_NE(
+	    formatted.find(
+	        "artemis_latency_seconds_bucket{stage=\"detect\",le=\"+Inf\"} 3\n"
+	    ),
+	    std::string::npos
+	) << formatted;
+	EXPECT_NE(
+	    formatted.find("artemis_latency_seconds_sum{stage=\"detect\"} 20.0035\n"),
+	    std::string::npos
+	) << formatted;
+	EXPECT_NE(
+	    formatted.find("artemis_latency_seconds_count{stage=\"detect\"} 3\n"),
+	    std::string::npos
+	) << formatted;
+}
+
+TEST_F(MetricsTest, ChecksRegistrations) {
+	Metrics    metrics;
+	const auto zero = []() { return 0.0; };
+	EXPECT_THROW(metrics.AddGauge("", "", zero), std::invalid_argument);
+	EXPECT_THROW(metrics.AddGauge("0abc", "", zero), std::invalid_argument);
+	EXPECT_THROW(metrics.AddGauge("a-b", "", zero), std::invalid_argument);
+	EXPECT_THROW(
+	    metrics.AddGauge("a", "", zero, {{"le", "1"}}),
+	    std::invalid_argument
+	);
+
+	EXPECT_NO_THROW(metrics.AddGauge("a", "", zero));
+	EXPECT_THROW(metrics.AddGauge("a", "", zero), std::invalid_argument);
+	EXPECT_THROW(metrics.AddCounter("a", "", zero), std::invalid_argument);
+	EXPECT_NO_THROW(metrics.AddGauge("a", "", zero, {{"b", "c"}}));
+}
+
+} // namespace artemis
+} // namespace fort
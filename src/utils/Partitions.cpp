@@ -1,5 +1,8 @@
 #include "Partitions.hpp"
 
+#include <algorithm>
+#include <stdexcept>
+
 namespace fort {
 namespace artemis {
 
@@ -41,6 +44,178 @@ void PartitionRectangle(
 	PartitionRectangle(b, partitions / 2, results);
 }
 
+CostMap::CostMap(const Size &size, int cellSize, double smoothing)
+    : d_size{size}
+    , d_cellSize{cellSize}
+    , d_columns{(size.width() + cellSize - 1) / cellSize}
+    , d_rows{(size.height() + cellSize - 1) / cellSize}
+    , d_smoothing{smoothing}
+    , d_costs(d_columns * d_rows, 0.0)
+    , d_pendingCosts(d_columns * d_rows, 0.0)
+    , d_pendingCoverages(d_columns * d_rows, 0.0)
+    , d_measured(d_columns * d_rows, false)
+    , d_unmeasured(d_columns * d_rows) {}
+
+template <typename Function>
+void CostMap::forEachCell(const Rect &rect, Function f) const {
+	const int right  = std::min(rect.x() + rect.width(), d_size.width());
+	const int bottom = std::min(rect.y() + rect.height(), d_size.height());
+	for (int y = std::max(rect.y(), 0) / d_cellSize;
+	     y < d_rows && y * d_cellSize < bottom;
+	     ++y) {
+		const int top = std::max(rect.y(), y * d_cellSize);
+		const int h   = std::min(bottom, (y + 1) * d_cellSize) - top;
+		for (int x = std::max(rect.x(), 0) / d_cellSize;
+		     x < d_columns && x * d_cellSize < right;
+		     ++x) {
+			const int left = std::max(rect.x(), x * d_cellSize);
+			const int w    = std::min(right, (x + 1) * d_cellSize) - left;
+			if (w > 0 && h > 0) {
+				f(y * d_columns + x, double(w) * double(h));
+			}
+		}
+	}
+}
+
+double CostMap::cellArea(size_t idx) const {
+	// cells on the right and bottom borders are clipped by the frame.
+	const int x = idx % d_columns, y = idx / d_columns;
+	return double(std::min(d_cellSize, d_size.width() - x * d_cellSize)) *
+	       double(std::min(d_cellSize, d_size.height() - y * d_cellSize));
+}
+
+void CostMap::Record(const Rect &rect, double cost) {
+	const double area = double(rect.width()) * double(rect.height());
+	if (area <= 0.0) {
+		return;
+	}
+	// rectangles may overlap, so we average their cost densities per cell.
+	const double density = cost / area;
+	forEachCell(rect, [&](size_t idx, double overlap) {
+		d_pendingCosts[idx] += density * overlap;
+		d_pendingCoverages[idx] += overlap;
+	});
+}
+
+void CostMap::Update() {
+	for (size_t idx = 0; idx < d_costs.size(); ++idx) {
+		if (d_pendingCoverages[idx] <= 0.0) {
+			continue;
+		}
+		const double measured =
+		    d_pendingCosts[idx] / d_pendingCoverages[idx] * cellArea(idx);
+
+		if (d_measured[idx] == false) {
+			d_measured[idx] = true;
+			--d_unmeasured;
+			d_costs[idx] = measured;
+		} else {
+			d_costs[idx] += d_smoothing * (measured - d_costs[idx]);
+		}
+		d_pendingCosts[idx]     = 0.0;
+		d_pendingCoverages[idx] = 0.0;
+	}
+}
+
+double CostMap::Cost(const Rect &rect) const {
+	double res = 0.0;
+	forEachCell(rect, [&](size_t idx, double overlap) {
+		res += d_costs[idx] * overlap / cellArea(idx);
+	});
+	return res;
+}
+
+bool CostMap::Empty() const {
+	return d_unmeasured > 0;
+}
+
+void CostMap::MarkEmptyCells(const CostMap &reference) {
+	if (reference.d_size != d_size || reference.d_cellSize != d_cellSize) {
+		throw std::invalid_argument("cost maps have different geometries");
+	}
+	for (size_t idx = 0; idx < d_costs.size(); ++idx) {
+		if (d_measured[idx] == true || reference.d_measured[idx] == false ||
+		    reference.d_costs[idx] > 0.0) {
+			continue;
+		}
+		d_measured[idx] = true;
+		--d_unmeasured;
+		d_costs[idx] = 0.0;
+	}
+}
+
+Rect FirstPart(const Rect &rect, bool vertical, int split) {
+	if (vertical) {
+		return {rect.TopLeft(), Size{rect.width(), split}};
+	}
+	return {rect.TopLeft(), Size{split, rect.height()}};
+}
+
+void PartitionInTwo(
+    const Rect    &rect,
+    double         fraction,
+    const CostMap &costs,
+    int            minSize,
+    Rect          &a,
+    Rect          &b
+) {
+	const bool vertical = rect.height() > rect.width();
+	const int  extent   = vertical ? rect.height() : rect.width();
+
+	const double total  = costs.Cost(rect);
+	const double target = fraction * total;
+	int          low    = std::min(minSize, extent / 2);
+	int          high   = extent - low;
+	if (target <= 0.0) {
+		// nothing measured, splits by area.
+		low = high = std::clamp(int(extent * fraction), low, high);
+	}
+	// the cost of the first part grows with the split position.
+	while (low < high) {
+		int    mid  = (low + high) / 2;
+		double cost = costs.Cost(FirstPart(rect, vertical, mid));
+		// tolerance for rounding errors when summing cells.
+		if (cost < target - 1e-9 * total) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+
+	a = FirstPart(rect, vertical, low);
+	if (vertical) {
+		b = {{rect.x(), rect.y() + low}, Size{rect.width(), extent - low}};
+	} else {
+		b = {{rect.x() + low, rect.y()}, Size{extent - low, rect.height()}};
+	}
+}
+
+void PartitionRectangle(
+    const Rect    &rect,
+    size_t         partitions,
+    const CostMap &costs,
+    int            minSize,
+    Partition     &results
+) {
+	if (partitions == 1) {
+		results.push_back(rect);
+		return;
+	}
+
+	if (partitions % 2 == 1) {
+		Rect single, rest;
+		PartitionInTwo(rect, 1.0 / partitions, costs, minSize, single, rest);
+		results.push_back(single);
+		PartitionRectangle(rest, partitions - 1, costs, minSize, results);
+		return;
+	}
+
+	Rect a, b;
+	PartitionInTwo(rect, 0.5, costs, minSize, a, b);
+	PartitionRectangle(a, partitions / 2, costs, minSize, results);
+	PartitionRectangle(b, partitions / 2, costs, minSize, results);
+}
+
 void AddMargin(const Size &size, int margin, Partition &partitions) {
 	for (auto &p : partitions) {
 		if (p.x() >= margin) {
@@ -71,5 +246,81 @@ void AddMargin(const Size &size, int margin, Partition &partitions) {
 	}
 }
 
+Rect Clamp(const Rect &rect, const Rect &bounds) {
+	int x      = std::max(rect.x(), bounds.x());
+	int y      = std::max(rect.y(), bounds.y());
+	int right =
+	    std::min(rect.x() + rect.width(), bounds.x() + bounds.width());
+	int bottom =
+	    std::min(rect.y() + rect.height(), bounds.y() + bounds.height());
+	return {{x, y}, {right - x, bottom - y}};
+}
+
+void BorderStrips(
+    const Rect      &bounds,
+    int              halfWidth,
+    const Partition &tiles,
+    Partition       &result
+) {
+	// each border is shared by two tiles, we only use the right and bottom
+	// borders. Strips extend along the border to cover the corners.
+	for (const auto &t : tiles) {
+		int right  = t.x() + t.width();
+		int bottom = t.y() + t.height();
+		if (right < bounds.x() + bounds.width()) {
+			result.push_back(Clamp(
+			    Rect{
+			        {right - halfWidth, t.y() - halfWidth},
+			        {2 * halfWidth, t.height() + 2 * halfWidth},
+			    },
+			    bounds
+			));
+		}
+		if (bottom < bounds.y() + bounds.height()) {
+			result.push_back(Clamp(
+			    Rect{
+			        {t.x() - halfWidth, bottom - halfWidth},
+			        {t.width() + 2 * halfWidth, 2 * halfWidth},
+			    },
+			    bounds
+			));
+		}
+	}
+}
+
+bool Overlaps(const Rect &a, const Rect &b) {
+	return a.x() < b.x() + b.width() && b.x() < a.x() + a.width() &&
+	       a.y() < b.y() + b.height() && b.y() < a.y() + a.height();
+}
+
+Rect BoundingBox(const Rect &a, const Rect &b) {
+	int x      = std::min(a.x(), b.x());
+	int y      = std::min(a.y(), b.y());
+	int right  = std::max(a.x() + a.width(), b.x() + b.width());
+	int bottom = std::max(a.y() + a.height(), b.y() + b.height());
+	return {{x, y}, {right - x, bottom - y}};
+}
+
+void MergeOverlapping(Partition &rects) {
+	bool merged = true;
+	while (merged) {
+		merged = false;
+		for (size_t i = 0; i < rects.size(); ++i) {
+			for (size_t j = i + 1; j < rects.size();) {
+				if (Overlaps(rects[i], rects[j]) == false) {
+					++j;
+					continue;
+				}
+				rects[i] = BoundingBox(rects[i], rects[j]);
+				rects[j] = rects.back();
+				rects.pop_back();
+				// rects[i] grew, it may now overlap previously tested ones.
+				j      = i + 1;
+				merged = true;
+			}
+		}
+	}
+}
+
 } // namespace artemis
 } // namespace fort
@@ -8,7 +8,71 @@ namespace artemis {
 typedef std::vector<Rect> Partition;
 void PartitionRectangle(const Rect &rect, size_t partitions, Partition &result);
 
+// Expected detection cost over a frame, on a grid of square cells. Measured
+// costs of processed rectangles are smoothed over frames.
+class CostMap {
+public:
+	CostMap(const Size &size, int cellSize, double smoothing);
+
+	// Records the cost of processing rect in the current frame.
+	void Record(const Rect &rect, double cost);
+	// Blends the costs recorded since the last call into the map. Cells not
+	// processed keep their previous cost.
+	void Update();
+
+	double Cost(const Rect &rect) const;
+
+	// Returns true until a full frame was recorded.
+	bool Empty() const;
+
+	// Marks the cells without cost in reference, a map of the same geometry,
+	// as measured with a zero cost. Masked cells are never recorded, but must
+	// not keep the map empty.
+	void MarkEmptyCells(const CostMap &reference);
+
+private:
+	template <typename Function>
+	void forEachCell(const Rect &rect, Function f) const;
+	double cellArea(size_t idx) const;
+
+	Size                d_size;
+	int                 d_cellSize;
+	int                 d_columns, d_rows;
+	double              d_smoothing;
+	std::vector<double> d_costs, d_pendingCosts, d_pendingCoverages;
+	std::vector<bool>   d_measured;
+	size_t              d_unmeasured;
+};
+
+// Same topology than the equal area version, but moves the boundaries so each
+// partition gets the same expected cost. Partitions are at least minSize wide
+// and high, if rect allows it.
+void PartitionRectangle(
+    const Rect    &rect,
+    size_t         partitions,
+    const CostMap &costs,
+    int            minSize,
+    Partition     &result
+);
+
 void AddMargin(const Size &maxSize, int margin, Partition &result);
 
+// Returns the intersection of rect and bounds.
+Rect Clamp(const Rect &rect, const Rect &bounds);
+
+// Adds to result the strips of width 2*halfWidth centered on the borders
+// between non-overlapping tiles of bounds, so objects cut by a border are
+// entirely in one strip, if smaller than halfWidth.
+void BorderStrips(
+    const Rect      &bounds,
+    int              halfWidth,
+    const Partition &tiles,
+    Partition       &result
+);
+
+// Replaces any group of overlapping rectangles by their bounding box, until no
+// rectangles in result overlap.
+void MergeOverlapping(Partition &result);
+
 } // namespace artemis
 } // namespace fort
@@ -76,6 +76,72 @@ TEST_F(PartitionsUTest, PartitionEqually) {
 	}
 }
 
+TEST_F(PartitionsUTest, CostMapAveragesOverlaps) {
+	CostMap costs{{200, 100}, 50, 0.5};
+	EXPECT_TRUE(costs.Empty());
+
+	costs.Record(Rect({0, 0}, {100, 100}), 4.0);
+	costs.Record(Rect({50, 0}, {150, 100}), 3.0);
+	costs.Update();
+	EXPECT_FALSE(costs.Empty());
+
+	EXPECT_DOUBLE_EQ(costs.Cost(Rect({0, 0}, {50, 100})), 2.0);
+	// overlapping column is the average of both densities.
+	EXPECT_DOUBLE_EQ(costs.Cost(Rect({50, 0}, {50, 100})), 1.5);
+	EXPECT_DOUBLE_EQ(costs.Cost(Rect({100, 0}, {100, 100})), 2.0);
+	EXPECT_DOUBLE_EQ(costs.Cost(Rect({0, 0}, {25, 50})), 0.5);
+
+	// only the recorded cells are smoothed.
+	costs.Record(Rect({0, 0}, {50, 100}), 4.0);
+	costs.Update();
+	EXPECT_DOUBLE_EQ(costs.Cost(Rect({0, 0}, {50, 100})), 3.0);
+	EXPECT_DOUBLE_EQ(costs.Cost(Rect({100, 0}, {100, 100})), 2.0);
+}
+
+TEST_F(PartitionsUTest, CostMapClipsBorderCells) {
+	// the last column and row of cells are 30 and 20 pixels wide.
+	CostMap costs{{130, 120}, 50, 1.0};
+	costs.Record(Rect({0, 0}, {130, 120}), 15.6);
+	costs.Update();
+
+	EXPECT_NEAR(costs.Cost(Rect({0, 0}, {130, 120})), 15.6, 1e-9);
+	EXPECT_NEAR(costs.Cost(Rect({0, 0}, {50, 50})), 2.5, 1e-9);
+	EXPECT_NEAR(costs.Cost(Rect({100, 0}, {30, 120})), 3.6, 1e-9);
+	EXPECT_NEAR(costs.Cost(Rect({0, 100}, {130, 20})), 2.6, 1e-9);
+	EXPECT_NEAR(costs.Cost(Rect({100, 100}, {15, 20})), 0.3, 1e-9);
+}
+
+TEST_F(PartitionsUTest, PartitionByCost) {
+	CostMap costs{{200, 100}, 10, 1.0};
+	Partition res;
+
+	costs.Record(Rect({0, 0}, {200, 100}), 0.0);
+	costs.Update();
+	// without any cost, partitions are equal.
+	PartitionRectangle(Rect({0, 0}, {200, 100}), 3, costs, 10, res);
+	EXPECT_EQ(res.size(), 3);
+	PartitionRectangle(Rect({0, 0}, {200, 100}), 3, res);
+	for (size_t i = 0; i < 3; ++i) {
+		EXPECT_EQ(res[i], res[i + 3]);
+	}
+
+	// all the work is in the left quarter.
+	costs.Record(Rect({0, 0}, {50, 100}), 4.0);
+	costs.Update();
+	res.clear();
+	PartitionRectangle(Rect({0, 0}, {200, 100}), 4, costs, 10, res);
+	Partition expected = {
+	    Rect({0, 0}, {25, 50}),
+	    Rect({0, 50}, {25, 50}),
+	    Rect({25, 0}, {13, 100}),
+	    Rect({38, 0}, {162, 100}),
+	};
+	EXPECT_EQ(res.size(), expected.size());
+	for (size_t i = 0; i < std::min(res.size(), expected.size()); ++i) {
+		EXPECT_EQ(res[i], expected[i]);
+	}
+}
+
 TEST_F(PartitionsUTest, MarginAdding) {
 	struct TestData {
 		Rect      Base;
@@ -121,5 +187,74 @@ TEST_F(PartitionsUTest, MarginAdding) {
 	}
 }
 
+TEST_F(PartitionsUTest, BorderStrips) {
+	Rect      bounds({10, 0}, {200, 100});
+	Partition tiles = {
+	    Rect({10, 0}, {40, 100}),
+	    Rect({50, 0}, {80, 50}),
+	    Rect({50, 50}, {80, 50}),
+	    Rect({130, 0}, {80, 100}),
+	};
+	Partition expected = {
+	    Rect({45, 0}, {10, 100}),
+	    Rect({125, 0}, {10, 55}),
+	    Rect({45, 45}, {90, 10}),
+	    Rect({125, 45}, {10, 55}),
+	};
+
+	Partition res;
+	BorderStrips(bounds, 5, tiles, res);
+	EXPECT_EQ(res.size(), expected.size());
+	for (size_t i = 0; i < std::min(res.size(), expected.size()); ++i) {
+		EXPECT_EQ(res[i], expected[i]);
+	}
+}
+
+TEST_F(PartitionsUTest, MergeOverlapping) {
+	struct TestData {
+		Partition Rects;
+		Partition Expected;
+	};
+
+	std::vector<TestData> testdata = {
+	    {
+	        .Rects =
+	            {
+	                Rect({0, 0}, {10, 10}),
+	                Rect({10, 0}, {10, 10}),
+	            },
+	        .Expected =
+	            {
+	                Rect({0, 0}, {10, 10}),
+	                Rect({10, 0}, {10, 10}),
+	            },
+	    },
+	    {
+	        .Rects =
+	            {
+	                Rect({0, 0}, {10, 10}),
+	                Rect({5, 5}, {10, 10}),
+	                Rect({20, 20}, {5, 5}),
+	                Rect({14, 0}, {10, 3}),
+	            },
+	        .Expected =
+	            {
+	                Rect({0, 0}, {24, 15}),
+	                Rect({20, 20}, {5, 5}),
+	            },
+	    },
+	};
+
+	for (auto const &d : testdata) {
+		Partition res = d.Rects;
+		MergeOverlapping(res);
+		EXPECT_EQ(res.size(), d.Expected.size());
+
+		for (size_t i = 0; i < std::min(res.size(), d.Expected.size()); ++i) {
+			EXPECT_EQ(res[i], d.Expected[i]);
+		}
+	}
+}
+
 } // namespace artemis
 } // namespace fort
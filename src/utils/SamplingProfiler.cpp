@@ -0,0 +1,348 @@
+#include "SamplingProfiler.hpp"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+#include <slog++/slog++.hpp>
+
+namespace fort {
+namespace artemis {
+
+namespace details {
+constexpr char PROFILE_MAGIC[8] = {'A', 'R', 'T', 'P', 'R', 'O', 'F', '1'};
+
+// The file is a header, a ring of Capacity samples, and once stopped the
+// objects of all the sampled addresses.
+struct ProfileHeader {
+	char     Magic[8];
+	uint32_t MaxDepth;
+	// files written by a different cpptrace build cannot be read.
+	uint32_t ObjectSize;
+	uint64_t PeriodUS;
+	uint64_t Capacity;
+	// incremented by the signal handler, the ring holds the last samples.
+	uint64_t Written;
+	uint64_t Objects;
+};
+
+struct ProfileSample {
+	uint64_t            Time;
+	uint32_t            Thread;
+	uint32_t            Depth;
+	cpptrace::frame_ptr Frames[SamplingProfiler::MAX_DEPTH];
+};
+
+struct ProfileObject {
+	uint64_t                    Address;
+	cpptrace::safe_object_frame Frame;
+};
+
+static_assert(sizeof(cpptrace::frame_ptr) == sizeof(uint64_t));
+static_assert(std::atomic_ref<uint64_t>::is_always_lock_free);
+
+struct ProfilerState {
+	int                   FD      = -1;
+	char                 *Mapping = nullptr;
+	size_t                Size    = 0;
+	ProfileHeader        *Header  = nullptr;
+	ProfileSample        *Samples = nullptr;
+	std::filesystem::path Path;
+};
+
+static std::mutex       profilerMutex;
+static ProfilerState    profiler;
+// the mapping is only released once no handler is running.
+static std::atomic<bool> sampling{false};
+static std::atomic<int>  handlersRunning{0};
+
+// Only uses async-signal-safe calls.
+void onProfilingSignal(int, siginfo_t *, void *) {
+	const int savedErrno = errno;
+	++handlersRunning;
+	if (sampling.load()) {
+		auto         header = profiler.Header;
+		const size_t index =
+		    std::atomic_ref<uint64_t>(header->Written).fetch_add(1) %
+		    header->Capacity;
+		auto &sample = profiler.Samples[index];
+
+		struct timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		sample.Time   = uint64_t(now.tv_sec) * 1000000000ULL + now.tv_nsec;
+		sample.Thread = uint32_t(syscall(SYS_gettid));
+		sample.Depth  = uint32_t(cpptrace::safe_generate_raw_trace(
+		    sample.Frames,
+		    SamplingProfiler::MAX_DEPTH
+		));
+	}
+	--handlersRunning;
+	errno = savedErrno;
+}
+
+void WriteAll(int fd, const char *data, size_t size, off_t offset) {
+	while (size > 0) {
+		const auto written = pwrite(fd, data, size, offset);
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::runtime_error(
+			    std::string("could not write profile: ") + strerror(errno)
+			);
+		}
+		data += written;
+		offset += written;
+		size -= written;
+	}
+}
+
+void ReadAll(std::istream &in, void *data, size_t size) {
+	in.read(reinterpret_cast<char *>(data), size);
+	if (in.gcount() != std::streamsize(size)) {
+		throw std::runtime_error("truncated profile");
+	}
+}
+} // namespace details
+
+void SamplingProfiler::Start(
+    const std::filesystem::path &path, size_t frequency, size_t capacity
+) {
+	using namespace details;
+	if (frequency == 0 || frequency > 1000000 || capacity == 0) {
+		throw std::invalid_argument(
+		    "invalid sampling frequency (" + std::to_string(frequency) +
+		    ") or capacity (" + std::to_string(capacity) + ")"
+		);
+	}
+
+	std::lock_guard<std::mutex> lock{profilerMutex};
+	if (profiler.Header != nullptr) {
+		throw std::logic_error("sampling profiler already started");
+	}
+
+	const auto fail = [&path](const std::string &what) {
+		const std::string reason = strerror(errno);
+		if (profiler.Mapping != nullptr) {
+			munmap(profiler.Mapping, profiler.Size);
+		}
+		if (profiler.FD >= 0) {
+			close(profiler.FD);
+		}
+		profiler = ProfilerState{};
+		throw std::runtime_error(
+		    "could not " + what + " '" + path.string() + "': " + reason
+		);
+	};
+
+	profiler.Path = path;
+	profiler.Size = sizeof(ProfileHeader) + capacity * sizeof(ProfileSample);
+	profiler.FD =
+	    open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (profiler.FD < 0) {
+		fail("open");
+	}
+	if (ftruncate(profiler.FD, profiler.Size) != 0) {
+		fail("allocate");
+	}
+	void *mapping = mmap(
+	    nullptr,
+	    profiler.Size,
+	    PROT_READ | PROT_WRITE,
+	    MAP_SHARED,
+	    profiler.FD,
+	    0
+	);
+	if (mapping == MAP_FAILED) {
+		fail("map");
+	}
+	profiler.Mapping = reinterpret_cast<char *>(mapping);
+	profiler.Header  = reinterpret_cast<ProfileHeader *>(profiler.Mapping);
+	profiler.Samples = reinterpret_cast<ProfileSample *>(
+	    profiler.Mapping + sizeof(ProfileHeader)
+	);
+
+	const uint64_t periodUS = std::max(1000000 / frequency, size_t(1));
+	*profiler.Header        = ProfileHeader{
+	    .MaxDepth   = MAX_DEPTH,
+	    .ObjectSize = sizeof(cpptrace::safe_object_frame),
+	    .PeriodUS   = periodUS,
+	    .Capacity   = capacity,
+	    .Written    = 0,
+	    .Objects    = 0,
+	};
+	memcpy(profiler.Header->Magic, PROFILE_MAGIC, sizeof(PROFILE_MAGIC));
+
+	// loads the unwinder now, as it cannot be done from the handler.
+	cpptrace::frame_ptr warmup[4];
+	cpptrace::safe_generate_raw_trace(warmup, 4);
+
+	struct sigaction action = {};
+	action.sa_sigaction     = &onProfilingSignal;
+	// SIGPROF must not make the interrupted system calls fail.
+	action.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&action.sa_mask);
+	if (sigaction(SIGPROF, &action, nullptr) != 0) {
+		fail("install the profiling handler for");
+	}
+
+	sampling.store(true);
+	struct itimerval timer = {};
+	timer.it_interval.tv_sec  = periodUS / 1000000;
+	timer.it_interval.tv_usec = periodUS % 1000000;
+	timer.it_value            = timer.it_interval;
+	if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+		sampling.store(false);
+		signal(SIGPROF, SIG_IGN);
+		fail("start the profiling timer for");
+	}
+
+	slog::Info(
+	    "sampling profiler started",
+	    slog::String("path", path.string()),
+	    slog::Int("frequency", frequency),
+	    slog::Int("capacity", capacity)
+	);
+}
+
+void SamplingProfiler::Stop() {
+	using namespace details;
+	std::lock_guard<std::mutex> lock{profilerMutex};
+	if (profiler.Header == nullptr) {
+		return;
+	}
+
+	struct itimerval disabled = {};
+	setitimer(ITIMER_PROF, &disabled, nullptr);
+	sampling.store(false);
+	while (handlersRunning.load() != 0) {
+		std::this_thread::yield();
+	}
+	// a pending SIGPROF would terminate the process.
+	signal(SIGPROF, SIG_IGN);
+
+	const auto &header  = *profiler.Header;
+	const auto  samples = std::min(header.Written, header.Capacity);
+
+	std::set<uint64_t> addresses;
+	for (size_t i = 0; i < samples; ++i) {
+		const auto &sample = profiler.Samples[i];
+		addresses.insert(sample.Frames, sample.Frames + sample.Depth);
+	}
+
+	std::vector<ProfileObject> objects;
+	objects.reserve(addresses.size());
+	for (const auto address : addresses) {
+		objects.push_back({.Address = address});
+		cpptrace::get_safe_object_frame(address, &objects.back().Frame);
+	}
+
+	try {
+		WriteAll(
+		    profiler.FD,
+		    reinterpret_cast<const char *>(objects.data()),
+		    objects.size() * sizeof(ProfileObject),
+		    profiler.Size
+		);
+		profiler.Header->Objects = objects.size();
+	} catch (const std::exception &e) {
+		slog::Error("could not complete profile", slog::Err(e));
+	}
+
+	slog::Info(
+	    "sampling profiler stopped",
+	    slog::String("path", profiler.Path.string()),
+	    slog::Int("samples", header.Written),
+	    slog::Int("kept", samples),
+	    slog::Int("addresses", objects.size())
+	);
+
+	msync(profiler.Mapping, profiler.Size, MS_SYNC);
+	munmap(profiler.Mapping, profiler.Size);
+	close(profiler.FD);
+	profiler = ProfilerState{};
+}
+
+bool SamplingProfiler::IsProfile(const std::filesystem::path &path) {
+	std::ifstream in{path, std::ios::binary};
+	char          magic[sizeof(details::PROFILE_MAGIC)];
+	in.read(magic, sizeof(magic));
+	return in.gcount() == sizeof(magic) &&
+	       memcmp(magic, details::PROFILE_MAGIC, sizeof(magic)) == 0;
+}
+
+SamplingProfiler::Profile
+SamplingProfiler::Load(const std::filesystem::path &path) {
+	using namespace details;
+	std::ifstream in{path, std::ios::binary};
+	if (in.is_open() == false) {
+		throw std::runtime_error("could not open '" + path.string() + "'");
+	}
+
+	ProfileHeader header;
+	ReadAll(in, &header, sizeof(header));
+	if (memcmp(header.Magic, PROFILE_MAGIC, sizeof(PROFILE_MAGIC)) != 0) {
+		throw std::runtime_error("'" + path.string() + "' is not a profile");
+	}
+	if (header.MaxDepth != MAX_DEPTH ||
+	    header.ObjectSize != sizeof(cpptrace::safe_object_frame)) {
+		throw std::runtime_error(
+		    "'" + path.string() + "' was written by an incompatible build"
+		);
+	}
+	const auto samples = std::min(header.Written, header.Capacity);
+	if (samples > 0 && header.Objects == 0) {
+		throw std::runtime_error(
+		    "'" + path.string() + "' is incomplete, as the profiler was not "
+		    "stopped"
+		);
+	}
+
+	Profile res{
+	    .PeriodUS = header.PeriodUS,
+	    .Lost     = header.Written - samples,
+	};
+	res.Samples.reserve(samples);
+	for (size_t i = 0; i < samples; ++i) {
+		ProfileSample sample;
+		ReadAll(in, &sample, sizeof(sample));
+		res.Samples.push_back({
+		    .Time   = sample.Time,
+		    .Thread = sample.Thread,
+		    .Frames = {
+		        sample.Frames,
+		        sample.Frames + std::min(sample.Depth, uint32_t(MAX_DEPTH))
+		    },
+		});
+	}
+	std::sort(
+	    res.Samples.begin(),
+	    res.Samples.end(),
+	    [](const Sample &a, const Sample &b) { return a.Time < b.Time; }
+	);
+
+	in.seekg(sizeof(ProfileHeader) + header.Capacity * sizeof(ProfileSample));
+	for (size_t i = 0; i < header.Objects; ++i) {
+		ProfileObject object;
+		ReadAll(in, &object, sizeof(object));
+		res.Objects[object.Address] = object.Frame;
+	}
+
+	return res;
+}
+
+} // namespace artemis
+} // namespace fort
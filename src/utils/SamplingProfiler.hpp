@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <vector>
+
+#include <cpptrace/cpptrace.hpp>
+
+namespace fort {
+namespace artemis {
+
+// Statistical CPU profiler for the whole process. SIGPROF is raised every
+// period of CPU time consumed by any thread, and its handler records the
+// stack of the interrupted thread in a memory mapped ring file, with the
+// same signal-safe calls as the crash handler. Symbols are only resolved
+// offline, by artemis-tracer, so it can run on rigs without perf.
+class SamplingProfiler {
+public:
+	constexpr static size_t MAX_DEPTH = 62;
+
+	struct Sample {
+		// CLOCK_MONOTONIC time, in nanoseconds.
+		uint64_t              Time;
+		uint32_t              Thread;
+		// from the innermost frame, the signal handler included.
+		std::vector<uint64_t> Frames;
+	};
+
+	struct Profile {
+		uint64_t            PeriodUS;
+		// samples overwritten as the ring was full.
+		uint64_t            Lost;
+		std::vector<Sample> Samples;
+		// objects of the sampled addresses, to resolve them.
+		std::map<uint64_t, cpptrace::safe_object_frame> Objects;
+	};
+
+	// Starts sampling at frequency Hz of CPU time, keeping the last capacity
+	// samples in path. Throws std::invalid_argument on invalid arguments,
+	// std::runtime_error if it cannot sample, or std::logic_error if already
+	// started.
+	static void
+	Start(const std::filesystem::path &path, size_t frequency, size_t capacity);
+
+	// Stops sampling, and completes the file with the objects of the sampled
+	// addresses. Without it, the file cannot be resolved.
+	static void Stop();
+
+	static bool IsProfile(const std::filesystem::path &path);
+
+	// Reads a file written by Start() and Stop(). Throws std::runtime_error
+	// if it is not a complete profile.
+	static Profile Load(const std::filesystem::path &path);
+};
+
+} // namespace artemis
+} // namespace fort
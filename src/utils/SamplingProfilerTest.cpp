@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <set>
+#include <thread>
+
+#include "SamplingProfiler.hpp"
+
+namespace fort {
+namespace artemis {
+
+class SamplingProfilerTest : public ::testing::Test {
+protected:
+	void SetUp() {
+		d_path = std::filesystem::temp_directory_path() /
+		         ("artemis-profile-" + std::to_string(getpid()));
+	}
+
+	void TearDown() {
+		SamplingProfiler::Stop();
+		std::filesystem::remove(d_path);
+	}
+
+	std::filesystem::path d_path;
+};
+
+namespace details {
+double Burn(std::chrono::milliseconds duration) {
+	const auto end = std::chrono::steady_clock::now() + duration;
+	double     res = 0.0;
+	while (std::chrono::steady_clock::now() < end) {
+		for (int i = 0; i < 1000; ++i) {
+			res += std::sqrt(double(i));
+		}
+	}
+	return res;
+}
+} // namespace details
+
+TEST_F(SamplingProfilerTest, SamplesAllThreads) {
+	SamplingProfiler::Start(d_path, 1000, 16);
+	EXPECT_THROW(SamplingProfiler::Start(d_path, 1000, 16), std::logic_error);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < 2; ++i) {
+		threads.emplace_back([]() {
+			details::Burn(std::chrono::milliseconds(300));
+		});
+	}
+	details::Burn(std::chrono::milliseconds(300));
+	for (auto &t : threads) {
+		t.join();
+	}
+	SamplingProfiler::Stop();
+
+	ASSERT_TRUE(SamplingProfiler::IsProfile(d_path));
+	const auto profile = SamplingProfiler::Load(d_path);
+	EXPECT_EQ(profile.PeriodUS, 1000);
+	ASSERT_GT(profile.Samples.size(), 0);
+	EXPECT_LE(profile.Samples.size(), 16);
+	// the ring keeps the last samples.
+	EXPECT_GT(profile.Lost, 0);
+
+	std::set<uint32_t> threadIDs;
+	for (size_t i = 0; i < profile.Samples.size(); ++i) {
+		const auto &sample = profile.Samples[i];
+		threadIDs.insert(sample.Thread);
+		EXPECT_GT(sample.Frames.size(), 0);
+		EXPECT_LE(sample.Frames.size(), SamplingProfiler::MAX_DEPTH);
+		if (i > 0) {
+			EXPECT_GE(sample.Time, profile.Samples[i - 1].Time);
+		}
+		for (const auto address : sample.Frames) {
+			EXPECT_EQ(profile.Objects.count(address), 1);
+		}
+	}
+	EXPECT_GT(threadIDs.size(), 1);
+}
+
+TEST_F(SamplingProfilerTest, ChecksArguments) {
+	EXPECT_THROW(SamplingProfiler::Start(d_path, 0, 16), std::invalid_argument);
+	EXPECT_THROW(
+	    SamplingProfiler::Start(d_path, 100, 0),
+	    std::invalid_argument
+	);
+	EXPECT_THROW(
+	    SamplingProfiler::Start("/nonexistent/profile", 100, 16),
+	    std::runtime_error
+	);
+	EXPECT_FALSE(SamplingProfiler::IsProfile(d_path));
+	EXPECT_THROW(SamplingProfiler::Load(d_path), std::runtime_error);
+}
+
+TEST_F(SamplingProfilerTest, RejectsIncompleteProfiles) {
+	SamplingProfiler::Start(d_path, 1000, 16);
+	details::Burn(std::chrono::milliseconds(200));
+	// still running, the objects are not written yet.
+	EXPECT_TRUE(SamplingProfiler::IsProfile(d_path));
+	EXPECT_THROW(SamplingProfiler::Load(d_path), std::runtime_error);
+}
+
+} // namespace artemis
+} // namespace fort
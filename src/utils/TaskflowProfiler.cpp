@@ -0,0 +1,194 @@
+#include "TaskflowProfiler.hpp"
+
+#include <fstream>
+#include <iomanip>
+
+#include <slog++/slog++.hpp>
+
+namespace fort {
+namespace artemis {
+
+namespace details {
+void WriteJSONString(std::ostream &out, const std::string &value) {
+	out << '"';
+	for (char c : value) {
+		switch (c) {
+		case '"':
+			out << "\\\"";
+			break;
+		case '\\':
+			out << "\\\\";
+			break;
+		default:
+			if (uint8_t(c) < 0x20) {
+				out << ' ';
+			} else {
+				out << c;
+			}
+		}
+	}
+	out << '"';
+}
+} // namespace details
+
+TaskflowProfiler::TaskflowProfiler(
+    const std::filesystem::path &path, size_t skip, size_t frames
+)
+    : d_path{path}
+    , d_skip{skip}
+    , d_frames{frames}
+    , d_origin{Clock::now()} {
+	d_frameMarks.reserve(frames);
+}
+
+TaskflowProfiler::~TaskflowProfiler() {
+	if (d_seen > d_skip) {
+		Flush();
+	}
+}
+
+int64_t TaskflowProfiler::now() const {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+	           Clock::now() - d_origin
+	)
+	    .count();
+}
+
+void TaskflowProfiler::set_up(size_t numWorkers) {
+	d_workers.clear();
+	for (size_t i = 0; i < numWorkers; ++i) {
+		d_workers.push_back(std::make_unique<Worker>());
+	}
+}
+
+void TaskflowProfiler::FrameStarted(uint64_t frameID) {
+	if (d_written) {
+		return;
+	}
+	if (d_seen == d_skip) {
+		slog::Info(
+		    "tracing taskflow",
+		    slog::Int("frameID", frameID),
+		    slog::Int("frames", d_frames)
+		);
+		d_recording.store(true);
+	}
+	if (d_recording.load()) {
+		if (d_frameMarks.size() < d_frames) {
+			d_frameMarks.push_back({.ID = frameID, .Time = now()});
+		} else {
+			d_recording.store(false);
+		}
+	}
+	++d_seen;
+
+	// waits for the tasks of the recorded frames to complete.
+	if (d_seen > d_skip + d_frames && d_open.load() == 0) {
+		write();
+	}
+}
+
+void TaskflowProfiler::Flush() {
+	if (d_written) {
+		return;
+	}
+	d_recording.store(false);
+	write();
+}
+
+bool TaskflowProfiler::Written() const {
+	return d_written;
+}
+
+void TaskflowProfiler::on_entry(tf::WorkerView wv, tf::TaskView tv) {
+	auto &worker = *d_workers[wv.id()];
+	// nested tasks, e.g. corun by a task, are pushed while their parent is
+	// open, so exits always pop their own entry.
+	if (d_recording.load(std::memory_order_relaxed) == false) {
+		if (worker.Stack.empty() == false) {
+			worker.Stack.push_back({.Name = {}, .Begin = 0, .Recorded = false});
+		}
+		return;
+	}
+	++d_open;
+	worker.Stack.push_back({
+	    .Name     = tv.name(),
+	    .Begin    = now(),
+	    .Recorded = true,
+	});
+}
+
+void TaskflowProfiler::on_exit(tf::WorkerView wv, tf::TaskView tv) {
+	auto &worker = *d_workers[wv.id()];
+	if (worker.Stack.empty()) {
+		return;
+	}
+	auto entry = std::move(worker.Stack.back());
+	worker.Stack.pop_back();
+	if (entry.Recorded == false) {
+		return;
+	}
+	{
+		std::lock_guard<std::mutex> lock{worker.Mutex};
+		worker.Events.push_back({
+		    .Name  = std::move(entry.Name),
+		    .Begin = entry.Begin,
+		    .End   = now(),
+		});
+	}
+	--d_open;
+}
+
+void TaskflowProfiler::write() {
+	d_written = true;
+
+	std::ofstream out{d_path};
+	if (out.is_open() == false) {
+		slog::Error(
+		    "could not write taskflow trace",
+		    slog::String("path", d_path.string())
+		);
+		return;
+	}
+	// times are in microseconds, process 1 holds the workers, and thread 0
+	// the frame starts.
+	out << std::fixed << std::setprecision(3);
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,"
+	    << "\"args\":{\"name\":\"frames\"}}";
+	for (const auto &f : d_frameMarks) {
+		out << ",\n{\"name\":\"frame " << f.ID
+		    << "\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,\"ts\":"
+		    << f.Time / 1000.0 << ",\"args\":{\"frameID\":" << f.ID << "}}";
+	}
+
+	size_t events{0};
+	for (size_t i = 0; i < d_workers.size(); ++i) {
+		auto                       &worker = *d_workers[i];
+		std::lock_guard<std::mutex> lock{worker.Mutex};
+		out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+		    << i + 1 << ",\"args\":{\"name\":\"worker " << i << "\"}}";
+		for (const auto &e : worker.Events) {
+			out << ",\n{\"name\":";
+			// asynchronous tasks have no name.
+			details::WriteJSONString(out, e.Name.empty() ? "async" : e.Name);
+			out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << i + 1
+			    << ",\"ts\":" << e.Begin / 1000.0
+			    << ",\"dur\":" << (e.End - e.Begin) / 1000.0 << "}";
+		}
+		events += worker.Events.size();
+		worker.Events.clear();
+		worker.Events.shrink_to_fit();
+	}
+	out << "\n]}\n";
+
+	slog::Info(
+	    "taskflow trace written",
+	    slog::String("path", d_path.string()),
+	    slog::Int("frames", d_frameMarks.size()),
+	    slog::Int("events", events)
+	);
+}
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <taskflow/taskflow.hpp>
+
+namespace fort {
+namespace artemis {
+
+// Records when each task runs on each worker of an executor, for a window of
+// frames, and writes it as a Chrome trace JSON file that chrome://tracing and
+// Perfetto can open. Outside of the window, it only costs an atomic load per
+// task.
+class TaskflowProfiler : public tf::ObserverInterface {
+public:
+	// The first skip frames are not recorded, so the trace does not show the
+	// warm-up. The trace is written once frames frames were recorded.
+	TaskflowProfiler(
+	    const std::filesystem::path &path, size_t skip, size_t frames
+	);
+	virtual ~TaskflowProfiler();
+
+	// Marks the start of a frame. Not thread-safe, it must always be called
+	// from the same thread.
+	void FrameStarted(uint64_t frameID);
+
+	// Stops recording and writes what was recorded, if not done yet.
+	void Flush();
+
+	bool Written() const;
+
+	void set_up(size_t numWorkers) override;
+	void on_entry(tf::WorkerView wv, tf::TaskView tv) override;
+	void on_exit(tf::WorkerView wv, tf::TaskView tv) override;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Event {
+		std::string Name;
+		int64_t     Begin, End;
+	};
+
+	struct Entry {
+		std::string Name;
+		int64_t     Begin;
+		bool        Recorded;
+	};
+
+	struct Worker {
+		// only accessed by the worker itself.
+		std::vector<Entry> Stack;
+		// protected, as it is read by Flush().
+		std::mutex         Mutex;
+		std::vector<Event> Events;
+	};
+
+	struct Frame {
+		uint64_t ID;
+		int64_t  Time;
+	};
+
+	int64_t now() const;
+
+	void write();
+
+	const std::filesystem::path          d_path;
+	const size_t                         d_skip, d_frames;
+	const Clock::time_point              d_origin;
+	std::vector<std::unique_ptr<Worker>> d_workers;
+	std::vector<Frame>                   d_frameMarks;
+	size_t                               d_seen = 0;
+	std::atomic<bool>                    d_recording{false};
+	std::atomic<size_t>                  d_open{0};
+	bool                                 d_written = false;
+};
+
+} // namespace artemis
+} // namespace fort
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <unistd.h>
+
+#include "TaskflowProfiler.hpp"
+
+namespace fort {
+namespace artemis {
+
+class TaskflowProfilerTest : public ::testing::Test {
+protected:
+	void SetUp() override {
+		d_path = std::filesystem::temp_directory_path() /
+		         ("artemis-trace-" + std::to_string(getpid()) + ".json");
+		auto [first, second] = d_taskflow.emplace([]() {}, []() {});
+		first.name("first");
+		second.name("second");
+		first.precede(second);
+	}
+
+	void TearDown() override {
+		std::filesystem::remove(d_path);
+	}
+
+	std::string readTrace() {
+		std::ifstream     in{d_path};
+		std::stringstream content;
+		content << in.rdbuf();
+		return content.str();
+	}
+
+	static size_t count(const std::string &str, const std::string &pattern) {
+		size_t res{0};
+		for (auto pos = str.find(pattern); pos != std::string::npos;
+		     pos      = str.find(pattern, pos + 1)) {
+			++res;
+		}
+		return res;
+	}
+
+	std::filesystem::path d_path;
+	tf::Executor          d_executor{2};
+	tf::Taskflow          d_taskflow;
+};
+
+TEST_F(TaskflowProfilerTest, RecordsOnlyTheWindow) {
+	auto profiler =
+	    d_executor.make_observer<TaskflowProfiler>(d_path.string(), 1, 2);
+	for (uint64_t frameID = 10; frameID < 15; ++frameID) {
+		profiler->FrameStarted(frameID);
+		d_executor.run(d_taskflow).wait();
+	}
+	ASSERT_TRUE(profiler->Written());
+
+	const auto trace = readTrace();
+	EXPECT_EQ(
+	    trace.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0),
+	    0
+	);
+	EXPECT_EQ(count(trace, "\"name\":\"first\",\"ph\":\"X\""), 2);
+	EXPECT_EQ(count(trace, "\"name\":\"second\",\"ph\":\"X\""), 2);
+	EXPECT_EQ(count(trace, "\"name\":\"frame 10\""), 0);
+	EXPECT_EQ(count(trace, "\"name\":\"frame 11\""), 1);
+	EXPECT_EQ(count(trace, "\"name\":\"frame 12\""), 1);
+	EXPECT_EQ(count(trace, "\"name\":\"frame 13\""), 0);
+	EXPECT_EQ(count(trace, "\"name\":\"worker "), 2);
+}
+
+TEST_F(TaskflowProfilerTest, FlushesAPartialWindow) {
+	auto profiler =
+	    d_executor.make_observer<TaskflowProfiler>(d_path.string(), 0, 100);
+	profiler->FrameStarted(0);
+	d_executor.run(d_taskflow).wait();
+	EXPECT_FALSE(profiler->Written());
+
+	profiler->Flush();
+	EXPECT_TRUE(profiler->Written());
+	EXPECT_EQ(count(readTrace(), "\"name\":\"first\",\"ph\":\"X\""), 1);
+}
+
+} // namespace artemis
+} // namespace fort
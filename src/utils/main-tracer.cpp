@@ -1,13 +1,92 @@
 #include <cpptrace/basic.hpp>
+#include <algorithm>
 #include <iostream>
+#include <map>
+#include <string>
+#include <vector>
 
 #include <cpptrace/cpptrace.hpp>
 
-int main(int argc, char **argv) {
-	const char *filename = "artemistrace";
-	if (argc >= 2) {
-		filename = argv[1];
+#include "SamplingProfiler.hpp"
+
+using fort::artemis::SamplingProfiler;
+
+// Returns the names of the frames of each address, from the innermost inlined
+// one.
+std::map<uint64_t, std::vector<std::string>>
+resolveAddresses(const SamplingProfiler::Profile &profile) {
+	std::vector<uint64_t>  addresses;
+	cpptrace::object_trace objects;
+	for (const auto &[address, frame] : profile.Objects) {
+		addresses.push_back(address);
+		objects.frames.push_back(frame.resolve());
+	}
+
+	std::map<uint64_t, std::vector<std::string>> res;
+	std::vector<std::string>                     names;
+	size_t                                       i = 0;
+	// inlined frames come before the frame they are inlined in.
+	for (const auto &frame : objects.resolve().frames) {
+		std::string name = frame.symbol.empty() ? "[unknown]" : frame.symbol;
+		// ';' separates the frames in folded stacks.
+		std::replace(name.begin(), name.end(), ';', ':');
+		names.push_back(std::move(name));
+		if (frame.is_inline || i >= addresses.size()) {
+			continue;
+		}
+		res[addresses[i++]] = std::move(names);
+		names.clear();
+	}
+	return res;
+}
+
+// Prints a profile as folded stacks, as expected by flamegraph.pl.
+int foldProfile(const char *filename, bool perThread) {
+	const auto profile = SamplingProfiler::Load(filename);
+	const auto names   = resolveAddresses(profile);
+
+	std::map<std::string, size_t> folded;
+	for (const auto &sample : profile.Samples) {
+		std::vector<std::string> stack;
+		for (const auto address : sample.Frames) {
+			auto it = names.find(address);
+			if (it == names.end()) {
+				stack.push_back("[unknown]");
+				continue;
+			}
+			stack.insert(stack.end(), it->second.begin(), it->second.end());
+		}
+		// drops the signal handler and its trampoline.
+		auto handler = std::find_if(
+		    stack.rbegin(),
+		    stack.rend(),
+		    [](const std::string &name) {
+			    return name.find("onProfilingSignal") != std::string::npos ||
+			           name.find("__restore_rt") != std::string::npos;
+		    }
+		);
+		stack.erase(stack.begin(), handler.base());
+
+		std::string line;
+		if (perThread) {
+			line = "thread-" + std::to_string(sample.Thread);
+		}
+		for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+			line += (line.empty() ? "" : ";") + *it;
+		}
+		++folded[line];
 	}
+
+	for (const auto &[stack, count] : folded) {
+		std::cout << stack << " " << count << std::endl;
+	}
+	std::cerr << profile.Samples.size() << " samples every "
+	          << profile.PeriodUS << "us of CPU time, " << profile.Lost
+	          << " older ones were overwritten" << std::endl;
+	return 0;
+}
+
+int printTrace(const char *filename) {
 	auto fd = fopen(filename, "r");
 	if (fd == NULL) {
 		std::cerr << "Could not open '" << filename << "'" << std::endl;
@@ -32,3 +111,25 @@ int main(int argc, char **argv) {
 	trace.resolve().print();
 	return ret;
 }
+
+int main(int argc, char **argv) {
+	const char *filename  = "artemistrace";
+	bool        perThread = false;
+	for (int i = 1; i < argc; ++i) {
+		if (std::string(argv[i]) == "--per-thread") {
+			perThread = true;
+		} else {
+			filename = argv[i];
+		}
+	}
+
+	if (SamplingProfiler::IsProfile(filename) == false) {
+		return printTrace(filename);
+	}
+	try {
+		return foldProfile(filename, perThread);
+	} catch (const std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+}